@@ -0,0 +1,437 @@
+// Microbenchmarks for the engine hot paths. Every benchmark runs over a sweep
+// of snake lengths and board fill ratios, up to nearly full boards, and the
+// results are printed to stdout as JSON so they can be compared build over
+// build. Build with "make bench" and run ./snake-bench > bench.json.
+//
+// Each benchmark runs in batches. Mutating benchmarks rebuild their board
+// between batches, outside the timed region. ns/op statistics are over the
+// batches, and instructions/op come from the CPU's counters where Linux
+// perf_event_open() allows it.
+#ifdef __linux__
+    #define _GNU_SOURCE  // syscall() for perf_event_open
+#else
+    #define _POSIX_C_SOURCE 200809L  // setenv, dup and fileno under -std=c11
+#endif
+#include "game.h"
+#include "options.h"
+#include "render.h"
+#include "timing.h"
+#include <fcntl.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#ifdef __linux__
+    #include <linux/perf_event.h>
+    #include <sys/ioctl.h>
+    #include <sys/syscall.h>
+#endif
+
+#define BENCH_COLS 128    // Even columns and rows / 2 even: see cycleDirection()
+#define BENCH_ROWS 64
+#define BENCH_SEED 12345
+#define DEFAULT_MIN_MS 40 // Measured time per benchmark and scenario
+#define MAX_MIN_MS 600000
+#define MIN_BATCHES 8
+#define MAX_BATCHES 200   // Caps rebuild cost for tiny batches on nearly full boards
+#define PROBE_POINTS 4096 // Points per checkCollision / checkSnakeOverlap batch
+
+static const int snakeLengths[] = { 3, 512, 2048, 6144 };
+static const double fillRatios[] = { 0.0, 0.5, 0.9, 0.99 };
+
+/* ------------------ INSTRUCTION COUNTER ------------------*/
+static int perfFd = -1;
+
+static void openInstructionCounter(void) {
+#ifdef __linux__
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    perfFd = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+#endif
+}
+
+static void counterEnable(int on) {
+#ifdef __linux__
+    if (perfFd >= 0) ioctl(perfFd, on ? PERF_EVENT_IOC_ENABLE : PERF_EVENT_IOC_DISABLE, 0);
+#else
+    (void)on;
+#endif
+}
+
+static uint64_t counterRead(void) {
+    uint64_t value = 0;
+    if (perfFd >= 0 && read(perfFd, &value, sizeof(value)) != (ssize_t)sizeof(value)) value = 0;
+    return value;
+}
+
+/* ------------------ MEASUREMENT ------------------*/
+// Time and instructions of the timed regions in one batch
+typedef struct {
+    uint64_t ns;
+    uint64_t instructions;
+    uint64_t startNs;
+    uint64_t startInstructions;
+} Meter;
+
+static inline void meterStart(Meter *m) {
+    m->startInstructions = counterRead();
+    counterEnable(1);
+    m->startNs = monotonicNs();
+}
+
+static inline void meterStop(Meter *m) {
+    uint64_t now = monotonicNs();
+    counterEnable(0);
+    m->ns += now - m->startNs;
+    m->instructions += counterRead() - m->startInstructions;
+}
+
+// ns/op over batches (Welford), plus totals
+typedef struct {
+    unsigned long batches;
+    unsigned long long ops;
+    double mean;
+    double m2;
+    double min;
+    uint64_t totalNs;
+    uint64_t instructions;
+} Stats;
+
+static void addBatch(Stats *s, const Meter *m, long ops) {
+    double nsPerOp = (double)m->ns / (double)ops;
+    s->batches++;
+    s->ops += (unsigned long long)ops;
+    s->totalNs += m->ns;
+    s->instructions += m->instructions;
+    double delta = nsPerOp - s->mean;
+    s->mean += delta / (double)s->batches;
+    s->m2 += delta * (nsPerOp - s->mean);
+    if (s->batches == 1 || nsPerOp < s->min) s->min = nsPerOp;
+}
+
+static int enoughBatches(const Stats *s, uint64_t minNs) {
+    if (s->batches < MIN_BATCHES) return 0;
+    return s->totalNs >= minNs || s->batches >= MAX_BATCHES;
+}
+
+/* ------------------ BOARDS ------------------*/
+typedef struct {
+    int length;    // Snake length asked for
+    double fill;   // Fraction of cells taken by the snake and items
+} Scenario;
+
+// Direction along a Hamiltonian cycle: rows snake back and forth over
+// columns 1..cols-1 and column 0 leads back up. The start position from
+// initSnake() lies on it heading right, so the snake can follow it forever
+// without hitting itself.
+static Direction cycleDirection(const GameState *gs) {
+    Point h = snakeSegment(gs, 0);
+    int cols = gs->config.cols;
+    if (h.x == 0) return h.y == 0 ? RIGHT : UP;
+    if (h.y % 2 == 0) return h.x < cols - 1 ? RIGHT : DOWN;
+    if (h.x > 1) return LEFT;
+    return h.y == gs->config.rows - 1 ? LEFT : DOWN;
+}
+
+static void stepSnake(GameState *gs) {
+    steerSnake(gs, cycleDirection(gs));
+    moveSnake(gs);
+}
+
+static double boardFill(const GameState *gs) {
+    return 1.0 - (double)gs->freeCount / (double)gs->boardCells;
+}
+
+// Grow the snake along the cycle, then fill free cells with food. Returns 0
+// if the scenario cannot be built.
+static int buildBoard(GameState *gs, const Scenario *sc) {
+    seedGameState(gs, BENCH_SEED);
+    resetGameState(gs);
+    // Lay the body on a board without items, so it cannot eat the opening
+    // food on the way and end up longer than asked for. The food goes on
+    // the cells still free afterwards.
+    initSnake(gs);
+    gs->foodCount = 0;
+    gs->snake.length = sc->length;
+    while (gs->snake.segments < gs->snake.length && !gs->gameOver) stepSnake(gs);
+    placeFood(gs);
+    while (boardFill(gs) < sc->fill && placeFood(gs)) {}
+    return !gs->gameOver && gs->snake.segments == sc->length && gs->snake.length == sc->length;
+}
+
+// Items to add per batch so the fill ratio barely moves
+static long placementBatch(const GameState *gs) {
+    long ops = gs->freeCount / 4;
+    if (ops > 256) ops = 256;
+    return ops > 0 ? ops : 1;
+}
+
+/* ------------------ BENCHMARKS ------------------*/
+typedef struct {
+    GameState *gs;
+    Renderer *renderer;  // NULL if curses could not start
+    uint64_t minNs;
+    Point probes[PROBE_POINTS];
+    volatile int sink;   // Keeps probe results alive
+} Bench;
+
+typedef void (*BenchFn)(Bench *b, const Scenario *sc, Stats *s);
+
+static void benchMoveSnake(Bench *b, const Scenario *sc, Stats *s) {
+    while (!enoughBatches(s, b->minNs) && buildBoard(b->gs, sc)) {
+        Meter m = { 0, 0, 0, 0 };
+        meterStart(&m);
+        for (int i = 0; i < 256; i++) stepSnake(b->gs);
+        meterStop(&m);
+        addBatch(s, &m, 256);
+    }
+}
+
+static void makeProbes(Bench *b, int inBoundsOnly) {
+    Rng rng;
+    rngSeed(&rng, BENCH_SEED, 7);
+    for (int i = 0; i < PROBE_POINTS; i++) {
+        // One probe in ten lands just outside the board
+        int margin = !inBoundsOnly && rngBelow(&rng, 10) == 0;
+        b->probes[i].x = (int)rngBelow(&rng, BENCH_COLS + 2 * margin) - margin;
+        b->probes[i].y = (int)rngBelow(&rng, BENCH_ROWS + 2 * margin) - margin;
+    }
+}
+
+static void benchCheckCollision(Bench *b, const Scenario *sc, Stats *s) {
+    if (!buildBoard(b->gs, sc)) return;
+    makeProbes(b, 0);
+    while (!enoughBatches(s, b->minNs)) {
+        Meter m = { 0, 0, 0, 0 };
+        int hits = 0;
+        meterStart(&m);
+        for (int i = 0; i < PROBE_POINTS; i++) hits += checkCollision(b->gs, b->probes[i]);
+        meterStop(&m);
+        b->sink = hits;
+        addBatch(s, &m, PROBE_POINTS);
+    }
+}
+
+static void benchCheckSnakeOverlap(Bench *b, const Scenario *sc, Stats *s) {
+    if (!buildBoard(b->gs, sc)) return;
+    makeProbes(b, 1);
+    while (!enoughBatches(s, b->minNs)) {
+        Meter m = { 0, 0, 0, 0 };
+        int hits = 0;
+        meterStart(&m);
+        for (int i = 0; i < PROBE_POINTS; i++) hits += checkSnakeOverlap(b->gs, b->probes[i]);
+        meterStop(&m);
+        b->sink = hits;
+        addBatch(s, &m, PROBE_POINTS);
+    }
+}
+
+// Shared by the item placement benchmarks
+static void benchPlacement(Bench *b, const Scenario *sc, Stats *s, int (*place)(GameState *)) {
+    while (!enoughBatches(s, b->minNs) && buildBoard(b->gs, sc)) {
+        Meter m = { 0, 0, 0, 0 };
+        long ops = placementBatch(b->gs);
+        meterStart(&m);
+        for (long i = 0; i < ops; i++) place(b->gs);
+        meterStop(&m);
+        addBatch(s, &m, ops);
+    }
+}
+
+static void benchPlaceFood(Bench *b, const Scenario *sc, Stats *s) {
+    benchPlacement(b, sc, s, placeFood);
+}
+
+static void benchPlaceTempFood(Bench *b, const Scenario *sc, Stats *s) {
+    benchPlacement(b, sc, s, placeTempFood);
+}
+
+static void benchPlaceDeathItem(Bench *b, const Scenario *sc, Stats *s) {
+    benchPlacement(b, sc, s, placeDeathItem);
+}
+
+// One frame of timers and spawns, what advanceFrame() runs besides movement
+static void benchRunDueEvents(Bench *b, const Scenario *sc, Stats *s) {
+    while (!enoughBatches(s, b->minNs) && buildBoard(b->gs, sc)) {
+        Meter m = { 0, 0, 0, 0 };
+        meterStart(&m);
+        for (int i = 0; i < 1024; i++) {
+            b->gs->frame++;
+            runDueEvents(b->gs);
+        }
+        meterStop(&m);
+        addBatch(s, &m, 1024);
+    }
+}
+
+// A frame after one move: the usual incremental update
+static void benchDrawFrame(Bench *b, const Scenario *sc, Stats *s) {
+    if (!b->renderer) return;
+    while (!enoughBatches(s, b->minNs) && buildBoard(b->gs, sc)) {
+        Meter m = { 0, 0, 0, 0 };
+        b->renderer->redraw(b->renderer);
+        b->renderer->drawFrame(b->renderer, b->gs);
+        for (int i = 0; i < 64; i++) {
+            stepSnake(b->gs);
+            meterStart(&m);
+            b->renderer->drawFrame(b->renderer, b->gs);
+            meterStop(&m);
+        }
+        addBatch(s, &m, 64);
+    }
+}
+
+// A frame after the screen was wiped, as after a resize or restart
+static void benchDrawFull(Bench *b, const Scenario *sc, Stats *s) {
+    if (!b->renderer) return;
+    while (!enoughBatches(s, b->minNs) && buildBoard(b->gs, sc)) {
+        Meter m = { 0, 0, 0, 0 };
+        meterStart(&m);
+        for (int i = 0; i < 8; i++) {
+            b->renderer->redraw(b->renderer);
+            b->renderer->drawFrame(b->renderer, b->gs);
+        }
+        meterStop(&m);
+        addBatch(s, &m, 8);
+    }
+}
+
+static const struct {
+    const char *name;
+    BenchFn run;
+} benchmarks[] = {
+    { "moveSnake", benchMoveSnake },
+    { "checkCollision", benchCheckCollision },
+    { "checkSnakeOverlap", benchCheckSnakeOverlap },
+    { "placeFood", benchPlaceFood },
+    { "placeTempFood", benchPlaceTempFood },
+    { "placeDeathItem", benchPlaceDeathItem },
+    { "runDueEvents", benchRunDueEvents },
+    { "drawFrame", benchDrawFrame },
+    { "drawFull", benchDrawFull },
+};
+
+/* ------------------ RUNNER ------------------*/
+// Curses drawing into /dev/null: stdout is swapped out while the renderer
+// exists, and the JSON goes to a saved copy of the real stdout
+static Renderer *openOffscreenRenderer(const GameConfig *config) {
+    char lines[16], columns[16];
+    const char *term = getenv("TERM");
+    if (!term || !*term || strcmp(term, "dumb") == 0) setenv("TERM", "xterm", 1);
+    snprintf(lines, sizeof(lines), "%d", config->rows + 8);
+    snprintf(columns, sizeof(columns), "%d", config->cols + 40);
+    setenv("LINES", lines, 1);
+    setenv("COLUMNS", columns, 1);
+
+    int devNull = open("/dev/null", O_WRONLY);
+    if (devNull < 0) return NULL;
+    fflush(stdout);
+    dup2(devNull, STDOUT_FILENO);
+    close(devNull);
+
+    RenderOptions opts = { DEFAULT_BOOST_REFRESH, 0 };
+    return createCursesRenderer(config, &opts);
+}
+
+static void printUsage(const char *prog) {
+    fprintf(stderr,
+        "Usage: %s [options] > results.json\n"
+        "  --min-ms N       Measured time per benchmark and scenario (default %d, 1-%d)\n"
+        "  --filter NAME    Only run benchmarks whose name contains NAME\n",
+        prog, DEFAULT_MIN_MS, MAX_MIN_MS);
+}
+
+int main(int argc, char **argv) {
+    int minMs = DEFAULT_MIN_MS;
+    const char *filter = NULL;
+    for (int i = 1; i < argc; i++) {
+        const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+        int ok;
+        if (strcmp(argv[i], "--min-ms") == 0) {
+            ok = parseIntOption(argv[i], value, 1, MAX_MIN_MS, &minMs);
+        } else if (strcmp(argv[i], "--filter") == 0) {
+            ok = value != NULL;
+            filter = value;
+        } else {
+            ok = 0;
+        }
+        if (!ok) {
+            printUsage(argv[0]);
+            return 1;
+        }
+        i++;
+    }
+
+    GameConfig config = defaultGameConfig();
+    config.cols = BENCH_COLS;
+    config.rows = BENCH_ROWS;
+    config.maxFood = BENCH_COLS * BENCH_ROWS;
+    config.maxTempFood = 4096;
+    config.maxDeathItems = 4096;
+
+    static Bench bench;
+    bench.minNs = (uint64_t)minMs * 1000000ull;
+    bench.gs = createGameState(&config, BENCH_SEED);
+    if (!bench.gs) {
+        fprintf(stderr, "Cannot create a %dx%d game\n", config.cols, config.rows);
+        return 1;
+    }
+
+    FILE *json = fdopen(dup(STDOUT_FILENO), "w");
+    if (!json) {
+        fprintf(stderr, "Cannot duplicate stdout\n");
+        destroyGameState(bench.gs);
+        return 1;
+    }
+    openInstructionCounter();
+    bench.renderer = openOffscreenRenderer(&config);
+    if (!bench.renderer) fprintf(stderr, "Curses could not start, skipping the draw benchmarks\n");
+
+    fprintf(json, "{\n  \"board\": { \"cols\": %d, \"rows\": %d },\n", config.cols, config.rows);
+    fprintf(json, "  \"min_ms\": %d,\n  \"instruction_counter\": %s,\n", minMs, perfFd >= 0 ? "true" : "false");
+    fprintf(json, "  \"results\": [");
+
+    int first = 1;
+    for (size_t bi = 0; bi < sizeof(benchmarks) / sizeof(benchmarks[0]); bi++) {
+        if (filter && !strstr(benchmarks[bi].name, filter)) continue;
+        for (size_t li = 0; li < sizeof(snakeLengths) / sizeof(snakeLengths[0]); li++) {
+            for (size_t fi = 0; fi < sizeof(fillRatios) / sizeof(fillRatios[0]); fi++) {
+                Scenario sc = { snakeLengths[li], fillRatios[fi] };
+                // Fills below what the snake alone takes up are the same board
+                if (sc.fill > 0 && sc.fill * config.rows * config.cols <= sc.length) continue;
+
+                Stats s;
+                memset(&s, 0, sizeof(s));
+                benchmarks[bi].run(&bench, &sc, &s);
+                if (s.batches == 0) continue;
+
+                double variance = s.batches > 1 ? s.m2 / (double)(s.batches - 1) : 0.0;
+                fprintf(json, "%s\n    { \"name\": \"%s\", \"snake_length\": %d, \"fill\": %.2f, "
+                        "\"batches\": %lu, \"ops\": %llu, \"ns_per_op\": %.3f, \"ns_per_op_min\": %.3f, "
+                        "\"ns_per_op_variance\": %.4f, \"ns_per_op_stddev\": %.3f, \"instructions_per_op\": ",
+                        first ? "" : ",", benchmarks[bi].name, sc.length, sc.fill,
+                        s.batches, s.ops, s.mean, s.min, variance, sqrt(variance));
+                if (perfFd >= 0)
+                    fprintf(json, "%.1f }", (double)s.instructions / (double)s.ops);
+                else
+                    fprintf(json, "null }");
+                fflush(json);
+                first = 0;
+            }
+        }
+    }
+    fprintf(json, "\n  ]\n}\n");
+
+    if (bench.renderer) bench.renderer->destroy(bench.renderer);
+    if (perfFd >= 0) close(perfFd);
+    fclose(json);
+    destroyGameState(bench.gs);
+    return 0;
+}
@@ -6,11 +6,42 @@ static inline WINDOW *win_or_stdscr(WINDOW *win) {
     return win ? win : stdscr;
 }
 
+// Choose contrasting, readable defaults.
+const ColorPairSpec color_scheme[COLOR_PAIR_COUNT] = {
+    [COLOR_SNAKE_HEAD]    = { COLOR_YELLOW,  COLOR_BLACK },
+    [COLOR_SNAKE_BODY]    = { COLOR_WHITE,   COLOR_BLACK },
+    [COLOR_FOOD]          = { COLOR_GREEN,   COLOR_BLACK },
+    [COLOR_TEMP_FOOD]     = { COLOR_CYAN,    COLOR_BLACK },
+    [COLOR_SPECIAL_ITEM]  = { COLOR_MAGENTA, COLOR_BLACK },
+    [COLOR_BORDER]        = { COLOR_WHITE,   COLOR_BLACK },
+    [COLOR_TEXT]          = { COLOR_WHITE,   COLOR_BLACK },
+    [COLOR_ERROR]         = { COLOR_RED,     COLOR_BLACK },
+    [COLOR_SUCCESS]       = { COLOR_WHITE,   COLOR_BLACK },
+    [COLOR_WARNING]       = { COLOR_YELLOW,  COLOR_BLACK },
+    [COLOR_DEATH_ITEM]    = { COLOR_RED,     COLOR_BLACK },
+};
+
+chtype glyph_table[GLYPH_COUNT];
+
+// Compose every board glyph with its attributes once
+void build_glyph_table(void) {
+    glyph_table[GLYPH_EMPTY]            = ' ';
+    glyph_table[GLYPH_SNAKE_HEAD]       = '@' | ATTR_SNAKE_HEAD;
+    glyph_table[GLYPH_SNAKE_BODY]       = 'o' | ATTR_SNAKE_BODY;
+    glyph_table[GLYPH_FOOD]             = '*' | ATTR_FOOD;
+    glyph_table[GLYPH_TEMP_FOOD]        = 'T' | ATTR_TEMP_FOOD;
+    glyph_table[GLYPH_TEMP_FOOD_DOUBLE] = 'D' | ATTR_WARNING;
+    glyph_table[GLYPH_TEMP_FOOD_TRIPLE] = 'X' | ATTR_SUCCESS;
+    glyph_table[GLYPH_SPECIAL_ITEM]     = '$' | ATTR_SPECIAL_ITEM;
+    glyph_table[GLYPH_DEATH_ITEM]       = 'X' | ATTR_DEATH_ITEM;
+}
+
 int has_color_support(void) {
     return has_colors();
 }
 
 int init_colors(void) {
+    build_glyph_table();
     if (!has_colors()) {
         return 0;
     }
@@ -18,19 +49,10 @@ int init_colors(void) {
         return 0;
     }
 
-    // Initialize pairs. Choose contrasting, readable defaults.
-    // Fallback if COLOR_ constants are limited in some terminals.
-    init_pair(COLOR_SNAKE_HEAD,    COLOR_YELLOW,   COLOR_BLACK);
-    init_pair(COLOR_SNAKE_BODY,    COLOR_WHITE,    COLOR_BLACK);
-    init_pair(COLOR_FOOD,          COLOR_GREEN,      COLOR_BLACK);
-    init_pair(COLOR_TEMP_FOOD,     COLOR_CYAN,     COLOR_BLACK);
-    init_pair(COLOR_SPECIAL_ITEM,  COLOR_MAGENTA,  COLOR_BLACK);
-    init_pair(COLOR_BORDER,        COLOR_WHITE,    COLOR_BLACK);
-    init_pair(COLOR_TEXT,          COLOR_WHITE,    COLOR_BLACK);
-    init_pair(COLOR_ERROR,         COLOR_RED,      COLOR_BLACK);
-    init_pair(COLOR_SUCCESS,       COLOR_WHITE,    COLOR_BLACK);
-    init_pair(COLOR_WARNING,       COLOR_YELLOW,   COLOR_BLACK);
-    init_pair(COLOR_DEATH_ITEM,    COLOR_RED,      COLOR_BLACK);
+    // Initialize pairs from the shared colour scheme
+    for (short pair = 1; pair < COLOR_PAIR_COUNT; pair++) {
+        init_pair(pair, color_scheme[pair].fg, color_scheme[pair].bg);
+    }
 
     return 1;
 }
@@ -19,6 +19,17 @@
 #define COLOR_SUCCESS       9
 #define COLOR_WARNING       10
 #define COLOR_DEATH_ITEM    11
+#define COLOR_PAIR_COUNT    12  // Pair 0 is the terminal default
+
+// Foreground and background of a colour pair (COLOR_BLACK..COLOR_WHITE)
+typedef struct {
+    short fg;
+    short bg;
+} ColorPairSpec;
+
+// The colour scheme, indexed by pair number. init_colors() registers it with
+// curses and the ANSI renderer turns it into SGR sequences.
+extern const ColorPairSpec color_scheme[COLOR_PAIR_COUNT];
 
 // Attribute combinations
 #define ATTR_SNAKE_HEAD     (COLOR_PAIR(COLOR_SNAKE_HEAD) | A_BOLD)
@@ -33,12 +44,36 @@
 #define ATTR_WARNING        (COLOR_PAIR(COLOR_WARNING) | A_BOLD)
 #define ATTR_DEATH_ITEM     (COLOR_PAIR(COLOR_DEATH_ITEM) | A_BOLD)
 
+// Board glyphs, each drawn as one precomposed chtype (character | ATTR_*)
+typedef enum {
+    GLYPH_EMPTY,
+    GLYPH_SNAKE_HEAD,
+    GLYPH_SNAKE_BODY,
+    GLYPH_FOOD,
+    GLYPH_TEMP_FOOD,
+    GLYPH_TEMP_FOOD_DOUBLE,
+    GLYPH_TEMP_FOOD_TRIPLE,
+    GLYPH_SPECIAL_ITEM,
+    GLYPH_DEATH_ITEM,
+    GLYPH_COUNT
+} GlyphId;
+
+// Filled in by build_glyph_table(), which init_colors() calls
+extern chtype glyph_table[GLYPH_COUNT];
+
+// Cell for a board glyph, ready for a single waddch() with no attribute
+// changes on the window
+static inline chtype glyph_cell(GlyphId glyph) {
+    return glyph_table[glyph];
+}
+
 // Function prototypes
+void build_glyph_table(void);  // Needs no curses screen
 int init_colors(void);
 void cleanup_colors(void);
 int has_color_support(void);
 
-// Convenience functions for applying colors
+// Convenience functions for applying colors to text output
 void apply_snake_head_color(WINDOW *win);
 void apply_snake_body_color(WINDOW *win);
 void apply_food_color(WINDOW *win);
@@ -0,0 +1,139 @@
+// Input latency histograms, see latency.h. Only built by "make latency",
+// with -DSNAKE_LATENCY.
+#ifdef SNAKE_LATENCY
+
+#ifndef _WIN32
+    #define _POSIX_C_SOURCE 200809L  // sigaction under -std=c11
+#endif
+#include "latency.h"
+#include "timing.h"
+#include <signal.h>
+#include <stdio.h>
+
+// Log-linear buckets in microseconds, like HdrHistogram: exact below 16 us,
+// then 16 buckets per power of two, so every bucket is within 1/16 (6.25%)
+// of the values it holds
+#define SUB_BUCKET_BITS 4
+#define SUB_BUCKETS (1 << SUB_BUCKET_BITS)
+#define HIST_BUCKETS (SUB_BUCKETS * 36)  // Up to about 2^35 us, over 9 hours
+#define PENDING_CAP 16                   // Applied turns not yet on screen
+
+typedef struct {
+    const char *name;
+    uint64_t buckets[HIST_BUCKETS];
+    uint64_t count;
+    uint64_t sum;
+    uint64_t max;
+} LatencyHist;
+
+typedef struct {
+    uint64_t stamp;      // Key read
+    uint64_t appliedAt;  // Move that applied the turn
+} PendingTurn;
+
+static LatencyHist keyToMove = { "key -> move", { 0 }, 0, 0, 0 };
+static LatencyHist moveToScreen = { "move -> screen", { 0 }, 0, 0, 0 };
+static LatencyHist keyToScreen = { "key -> screen", { 0 }, 0, 0, 0 };
+static PendingTurn pending[PENDING_CAP];
+static int pendingCount = 0;
+static volatile sig_atomic_t dumpRequested = 0;
+
+static int bucketOf(uint64_t us) {
+    if (us < SUB_BUCKETS) return (int)us;
+    int shift = 0;
+    while ((us >> shift) >= 2 * SUB_BUCKETS) shift++;
+    int bucket = (shift + 1) * SUB_BUCKETS + (int)((us >> shift) - SUB_BUCKETS);
+    return bucket < HIST_BUCKETS ? bucket : HIST_BUCKETS - 1;
+}
+
+// Highest value a bucket holds
+static uint64_t bucketHigh(int bucket) {
+    if (bucket < SUB_BUCKETS) return (uint64_t)bucket;
+    int shift = bucket / SUB_BUCKETS - 1;
+    return ((uint64_t)(SUB_BUCKETS + bucket % SUB_BUCKETS + 1) << shift) - 1;
+}
+
+static void record(LatencyHist *h, uint64_t ns) {
+    uint64_t us = ns / 1000;
+    h->buckets[bucketOf(us)]++;
+    h->count++;
+    h->sum += us;
+    if (us > h->max) h->max = us;
+}
+
+static uint64_t percentile(const LatencyHist *h, double fraction) {
+    uint64_t target = (uint64_t)(fraction * (double)h->count + 0.999999);
+    uint64_t seen = 0;
+    if (target == 0) target = 1;
+    for (int i = 0; i < HIST_BUCKETS; i++) {
+        seen += h->buckets[i];
+        if (seen >= target) return bucketHigh(i) < h->max ? bucketHigh(i) : h->max;
+    }
+    return h->max;
+}
+
+static void printHist(const LatencyHist *h) {
+    if (h->count == 0) {
+        fprintf(stderr, "  %-15s %8d\n", h->name, 0);
+        return;
+    }
+    fprintf(stderr, "  %-15s %8llu %9.3f %9.3f %9.3f %9.3f\n", h->name,
+            (unsigned long long)h->count, (double)h->sum / (double)h->count / 1000.0,
+            (double)percentile(h, 0.50) / 1000.0, (double)percentile(h, 0.99) / 1000.0,
+            (double)h->max / 1000.0);
+}
+
+#ifndef _WIN32
+static void onDumpSignal(int sig) {
+    (void)sig;
+    dumpRequested = 1;
+}
+#endif
+
+void latencyInit(void) {
+#ifndef _WIN32
+    struct sigaction sa;
+    sa.sa_handler = onDumpSignal;
+    sa.sa_flags = 0;  // Interrupt the input wait so the dump comes at once
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGUSR1, &sa, NULL);
+#endif
+}
+
+void latencyAfterTick(GameState *gs) {
+    if (gs->appliedTurnStamp == 0) return;
+    uint64_t now = monotonicNs();
+    record(&keyToMove, now - gs->appliedTurnStamp);
+    if (pendingCount < PENDING_CAP) {
+        pending[pendingCount].stamp = gs->appliedTurnStamp;
+        pending[pendingCount].appliedAt = now;
+        pendingCount++;
+    }
+    gs->appliedTurnStamp = 0;
+}
+
+void latencyFrameShown(void) {
+    if (pendingCount == 0) return;
+    uint64_t now = monotonicNs();
+    for (int i = 0; i < pendingCount; i++) {
+        record(&moveToScreen, now - pending[i].appliedAt);
+        record(&keyToScreen, now - pending[i].stamp);
+    }
+    pendingCount = 0;
+}
+
+void latencyPoll(void) {
+    if (!dumpRequested) return;
+    dumpRequested = 0;
+    latencyDump();
+}
+
+void latencyDump(void) {
+    fprintf(stderr, "input latency (ms)   count      mean       p50       p99       max\n");
+    printHist(&keyToMove);
+    printHist(&moveToScreen);
+    printHist(&keyToScreen);
+    fflush(stderr);
+}
+
+#endif // SNAKE_LATENCY
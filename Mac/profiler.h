@@ -0,0 +1,63 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+// Per-phase frame profiler for the interactive loop. Phases are timed with
+// the monotonic clock and summed per frame (the time from one batch of
+// simulation ticks to the next). The last PROFILE_WINDOW frames feed
+// rolling averages and percentiles for the HUD, and every frame can be
+// streamed to a CSV file.
+//
+// While disabled, timing a phase costs one predictable branch: no clock is
+// read and nothing is stored.
+
+#include "timing.h"
+#include <stdint.h>
+
+#define PROFILE_WINDOW 128     // Frames behind the HUD averages and percentiles
+#define PROFILE_HUD_PERIOD 32  // Frames between HUD text updates
+
+typedef enum {
+    PHASE_INPUT,   // Reading keys into the turn queue
+    PHASE_MOVE,    // Frame counter and snake movement
+    PHASE_EVENTS,  // Due timers and spawns from the event queue
+    PHASE_DRAW,    // Renderer, including the terminal write
+    PHASE_WAIT,    // Sleeping until the next tick or key
+    PHASE_COUNT
+} ProfilePhase;
+
+extern int profilerEnabled;
+
+// Start timing, 0 while disabled
+static inline uint64_t profileStart(void) {
+    return profilerEnabled ? monotonicNs() : 0;
+}
+
+void profileAdd(ProfilePhase phase, uint64_t ns);
+
+// Charge the time since *start to phase and restart *start from now, so
+// back-to-back phases need one clock read each. A zero start (the profiler
+// was switched on since) only starts the clock.
+static inline void profileLap(ProfilePhase phase, uint64_t *start) {
+    if (!profilerEnabled) return;
+    uint64_t now = monotonicNs();
+    if (*start != 0) profileAdd(phase, now - *start);
+    *start = now;
+}
+
+// Stream every frame to path as CSV. Returns 0 (after printing why) if the
+// file cannot be created.
+int profilerOpenCsv(const char *path);
+void profilerClose(void);
+
+// Show or hide the HUD; the profiler runs while either is on
+void profilerToggleHud(void);
+int profilerHudVisible(void);
+
+// Close the current frame after a batch of ticks. Returns 1 when the HUD
+// text changed and should be drawn again.
+int profilerEndFrame(int ticks);
+
+// HUD line: rolling averages and p99s per phase, in microseconds
+const char *profilerHudText(void);
+
+#endif // PROFILER_H
@@ -0,0 +1,105 @@
+#ifndef RENDER_H
+#define RENDER_H
+
+// Renderer interface. main() talks to the terminal only through a Renderer:
+// the curses backend is the portable default, the ANSI backend writes raw
+// escape sequences with a single write() per frame.
+
+#include "colors.h"
+#include "game.h"
+
+#define DEFAULT_BOOST_REFRESH 20  // Frames between speed boost countdown updates
+#define RENDER_RESIZED (-2)       // readKey(): terminal resized, everything will be redrawn
+
+typedef struct {
+    int boostRefreshFrames;  // Speed boost countdown redraw cadence, in frames
+    int stats;               // Print bytes and syscalls per frame on exit
+} RenderOptions;
+
+typedef struct Renderer Renderer;
+struct Renderer {
+    const char *name;
+    // Next key, -1 if none is waiting, or RENDER_RESIZED
+    int (*readKey)(Renderer *r);
+    void (*flushInput)(Renderer *r);
+    // Wipe the screen; the next frame redraws everything
+    void (*redraw)(Renderer *r);
+    // Called every frame. Draws only what changed, and nothing at all when
+    // the game state did not change.
+    void (*drawFrame)(Renderer *r, GameState *gs);
+    void (*drawGameOver)(Renderer *r, GameState *gs);
+    // Text line under the status line (row rows + 4), empty text clears it.
+    // It reaches the screen with the next drawn frame.
+    void (*drawHud)(Renderer *r, const char *text);
+    // Restore the terminal, print stats if asked for, and free the renderer
+    void (*destroy)(Renderer *r);
+};
+
+// Both print why and return NULL on failure
+Renderer *createCursesRenderer(const GameConfig *config, const RenderOptions *opts);
+Renderer *createAnsiRenderer(const GameConfig *config, const RenderOptions *opts);
+
+/* ------------------ SHARED BY THE BACKENDS ------------------*/
+// What each board cell showed after the last frame. Together with the
+// GameState dirty list and version, it tells a backend which cells to draw.
+typedef struct {
+    unsigned char *drawn;  // GlyphId last drawn per cell, 0xFF if unknown
+    int cells;
+    int drawnHead;         // Cell the head was last drawn in, -1 if unknown
+    uint64_t drawnVersion; // GameState version on screen
+    uint64_t statusFrame;  // Frame the status line was last drawn on
+    int stale;             // Redraw even if the version did not move
+    int redrawAll;         // Screen was wiped, every cell needs drawing
+    int boostRefreshFrames;
+    unsigned long frames;  // Frames passed to boardViewBegin()
+    unsigned long drawnFrames;
+} BoardView;
+
+typedef void (*DrawCellFn)(void *ctx, int cell, GlyphId glyph);
+
+int boardViewInit(BoardView *v, const GameConfig *config, int boostRefreshFrames);
+void boardViewFree(BoardView *v);
+// Forget what is on screen, so the next frame redraws every cell
+void boardViewInvalidate(BoardView *v);
+// Start a frame. Returns 0 when nothing visible changed since the last one.
+int boardViewBegin(BoardView *v, const GameState *gs);
+// Call drawCell for every cell whose look changed and mark the board drawn
+void boardViewUpdate(BoardView *v, GameState *gs, DrawCellFn drawCell, void *ctx);
+
+// A line of text at a screen position, with its attributes (ATTR_*)
+typedef struct {
+    int row;
+    int col;
+    chtype attr;
+    char text[48];
+} TextLine;
+
+#define INSTRUCTION_ROWS 15
+#define STATUS_PARTS 2
+#define GAME_OVER_LINES 4
+
+// Instructions panel right of the board, NULL for blank rows
+extern const char *const instructionRows[INSTRUCTION_ROWS];
+int instructionsTop(void);
+int instructionsLeft(const GameConfig *config);
+
+// Status line under the board, as up to STATUS_PARTS differently coloured
+// pieces laid out left to right. Returns the number of pieces.
+int formatStatus(const GameState *gs, TextLine *parts);
+int hudRow(const GameConfig *config);
+void formatGameOver(const GameState *gs, TextLine *lines);
+
+// Kernel counters of this process's I/O, for backends that cannot count
+// their own writes (Linux only)
+typedef struct {
+    long long bytes;   // Bytes written
+    long long writes;  // write() calls
+    long long reads;   // read() calls
+} IoCounters;
+
+int readIoCounters(IoCounters *io);
+// maxBytes < 0 when unknown
+void printRenderStats(const char *name, const BoardView *v, long long bytes, long long maxBytes,
+                      long long writes, long long reads);
+
+#endif // RENDER_H
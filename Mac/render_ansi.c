@@ -0,0 +1,500 @@
+// ANSI renderer: talks to the terminal directly with escape sequences. Each
+// frame's cursor moves, SGR attribute changes and glyphs are composed into
+// one preallocated buffer and handed to the kernel with a single write().
+#ifndef _WIN32
+    #define _POSIX_C_SOURCE 200809L  // termios, sigaction and snprintf under -std=c11
+#endif
+#include "render.h"
+#include <stdio.h>
+
+#ifdef _WIN32
+
+Renderer *createAnsiRenderer(const GameConfig *config, const RenderOptions *opts) {
+    (void)config;
+    (void)opts;
+    fprintf(stderr, "The ansi renderer is not available on Windows, use --renderer curses\n");
+    return NULL;
+}
+
+#else
+
+#include <errno.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <termios.h>
+#include <unistd.h>
+
+#define ESC "\x1b"
+#define FRAME_BYTES_PER_CELL 24   // Worst case: cursor move, SGR and glyph
+#define FRAME_SLACK_BYTES 8192    // Chrome, status and game over text
+#define ATTR_UNKNOWN ((chtype)-1) // Terminal attributes not known, always emit SGR
+#define INPUT_BYTES 64            // Keyboard bytes read ahead of the game
+
+typedef struct {
+    Renderer base;
+    GameConfig config;
+    BoardView view;
+    int stats;
+    int in;                  // Keyboard
+    int out;                 // Terminal
+    struct termios savedTermios;
+    int termRows;
+    int termCols;
+
+    unsigned char input[INPUT_BYTES];  // Read but not yet returned by readKey
+    int inputPos;
+    int inputLen;
+    int escapeWaited;        // Already waited one call for the rest of an escape sequence
+
+    char *buf;               // Frame being composed
+    size_t len;
+    size_t cap;
+    int cursorRow;           // Terminal cursor, 0-based, -1 if unknown
+    int cursorCol;
+    chtype attr;             // Attributes the terminal is set to
+
+    TextLine status[STATUS_PARTS];  // Status line on screen
+    int statusParts;                // -1 if unknown
+
+    long long bytes;         // Written by frames
+    long long maxFrameBytes;
+    long long writes;        // write() calls
+    long long reads;         // read() calls
+} AnsiRenderer;
+
+static volatile sig_atomic_t terminalResized = 0;
+
+static void onWinch(int sig) {
+    (void)sig;
+    terminalResized = 1;
+}
+
+// What to put back if the process ends without destroy(): Ctrl-C, kill,
+// hangup or exit(). The signal path may only make async-signal-safe calls.
+static struct {
+    volatile sig_atomic_t active;
+    int in;
+    int out;
+    struct termios saved;
+} terminalGuard;
+
+static const int guardedSignals[] = { SIGINT, SIGTERM, SIGHUP, SIGQUIT };
+#define GUARDED_SIGNALS (int)(sizeof(guardedSignals) / sizeof(guardedSignals[0]))
+static struct sigaction previousActions[GUARDED_SIGNALS];
+
+static void releaseTerminal(void) {
+    static const char restore[] = ESC "[0m" ESC "[?25h" ESC "[?1049l";
+    if (!terminalGuard.active) return;
+    terminalGuard.active = 0;
+    ssize_t n = write(terminalGuard.out, restore, sizeof(restore) - 1);
+    (void)n;  // Terminal gone, nothing sensible left to do
+    tcsetattr(terminalGuard.in, TCSANOW, &terminalGuard.saved);
+}
+
+// Restore the terminal, then die of the signal as if we had not caught it
+static void onTerminate(int sig) {
+    releaseTerminal();
+    signal(sig, SIG_DFL);
+    raise(sig);
+}
+
+static void guardTerminal(AnsiRenderer *ar) {
+    static int atexitDone = 0;
+    if (!atexitDone) atexitDone = atexit(releaseTerminal) == 0;
+    terminalGuard.in = ar->in;
+    terminalGuard.out = ar->out;
+    terminalGuard.saved = ar->savedTermios;
+    terminalGuard.active = 1;
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = onTerminate;
+    sigemptyset(&sa.sa_mask);
+    for (int i = 0; i < GUARDED_SIGNALS; i++) {
+        sigaction(guardedSignals[i], NULL, &previousActions[i]);
+        if (previousActions[i].sa_handler != SIG_IGN) sigaction(guardedSignals[i], &sa, NULL);
+    }
+}
+
+static void unguardTerminal(void) {
+    releaseTerminal();
+    for (int i = 0; i < GUARDED_SIGNALS; i++) sigaction(guardedSignals[i], &previousActions[i], NULL);
+}
+
+/* ------------------ OUTPUT BUFFER ------------------*/
+// Write the whole buffer out. Normally that is one write(); partial writes
+// and signals just take more calls.
+static void flushBuffer(AnsiRenderer *ar) {
+    size_t done = 0;
+    while (done < ar->len) {
+        ssize_t n = write(ar->out, ar->buf + done, ar->len - done);
+        ar->writes++;
+        if (n < 0) {
+            if (errno == EINTR || errno == EAGAIN) continue;
+            break;  // Terminal gone, nothing sensible left to do
+        }
+        done += (size_t)n;
+    }
+    ar->len = 0;
+}
+
+static void emit(AnsiRenderer *ar, const char *data, size_t n) {
+    // The buffer is sized for a full redraw, so this only flushes early on
+    // absurdly large boards
+    if (ar->len + n > ar->cap) flushBuffer(ar);
+    memcpy(ar->buf + ar->len, data, n);
+    ar->len += n;
+}
+
+static void emitStr(AnsiRenderer *ar, const char *s) {
+    emit(ar, s, strlen(s));
+}
+
+// Move the cursor with the shortest sequence that gets there
+static void moveTo(AnsiRenderer *ar, int row, int col) {
+    char seq[32];
+    int n;
+    if (row == ar->cursorRow && col == ar->cursorCol) return;
+    if (row == ar->cursorRow && ar->cursorCol >= 0 && col > ar->cursorCol) {
+        n = col - ar->cursorCol == 1 ? snprintf(seq, sizeof(seq), ESC "[C")
+                                     : snprintf(seq, sizeof(seq), ESC "[%dC", col - ar->cursorCol);
+    } else if (col == 0) {
+        n = snprintf(seq, sizeof(seq), ESC "[%dH", row + 1);
+    } else {
+        n = snprintf(seq, sizeof(seq), ESC "[%d;%dH", row + 1, col + 1);
+    }
+    emit(ar, seq, (size_t)n);
+    ar->cursorRow = row;
+    ar->cursorCol = col;
+}
+
+// Switch to curses-style attributes (colour pair and bold), looking the
+// pair up in the same colour scheme init_colors() gives curses
+static void setAttr(AnsiRenderer *ar, chtype attr) {
+    char seq[32];
+    int n;
+    if (attr == ar->attr) return;
+    int pair = (int)PAIR_NUMBER(attr);
+    const char *bold = (attr & A_BOLD) ? ";1" : "";
+    if (pair > 0 && pair < COLOR_PAIR_COUNT) {
+        n = snprintf(seq, sizeof(seq), ESC "[0%s;%d;%dm", bold,
+                     30 + color_scheme[pair].fg, 40 + color_scheme[pair].bg);
+    } else {
+        n = snprintf(seq, sizeof(seq), ESC "[0%sm", bold);
+    }
+    emit(ar, seq, (size_t)n);
+    ar->attr = attr;
+}
+
+// Account for the cursor after printing width characters ending at col.
+// Printing into the last column leaves the cursor in an ambiguous
+// pending-wrap state, so forget where it is.
+static void advanceCursor(AnsiRenderer *ar, int endCol) {
+    ar->cursorCol = endCol < ar->termCols ? endCol : -1;
+    if (ar->cursorCol < 0) ar->cursorRow = -1;
+}
+
+// Text clipped to the terminal, like curses does
+static void emitText(AnsiRenderer *ar, int row, int col, chtype attr, const char *text) {
+    if (row < 0 || row >= ar->termRows || col < 0 || col >= ar->termCols) return;
+    size_t n = strlen(text);
+    if (n > (size_t)(ar->termCols - col)) n = (size_t)(ar->termCols - col);
+    moveTo(ar, row, col);
+    setAttr(ar, attr);
+    emit(ar, text, n);
+    advanceCursor(ar, col + (int)n);
+}
+
+/* ------------------ SCREEN ------------------*/
+// Border in DEC line drawing characters, instructions right of the board
+static void drawChrome(AnsiRenderer *ar) {
+    int rows = ar->config.rows;
+    int cols = ar->config.cols;
+    char *line = malloc((size_t)cols + 3);
+    if (!line) return;
+
+    setAttr(ar, ATTR_BORDER);
+    emitStr(ar, ESC "(0");
+    memset(line, 'q', (size_t)cols + 2);
+    line[0] = 'l';
+    line[cols + 1] = 'k';
+    line[cols + 2] = '\0';
+    emitText(ar, 0, 0, ATTR_BORDER, line);
+    for (int row = 1; row <= rows; row++) {
+        emitText(ar, row, 0, ATTR_BORDER, "x");
+        emitText(ar, row, cols + 1, ATTR_BORDER, "x");
+    }
+    line[0] = 'm';
+    line[cols + 1] = 'j';
+    emitText(ar, rows + 1, 0, ATTR_BORDER, line);
+    emitStr(ar, ESC "(B");
+    free(line);
+
+    for (int i = 0; i < INSTRUCTION_ROWS; i++) {
+        if (instructionRows[i])
+            emitText(ar, instructionsTop() + i, instructionsLeft(&ar->config), ATTR_TEXT, instructionRows[i]);
+    }
+}
+
+static void drawCell(void *ctx, int cell, GlyphId glyph) {
+    AnsiRenderer *ar = ctx;
+    chtype ch = glyph_cell(glyph);
+    char c = (char)(ch & A_CHARTEXT);
+    int col = cell % ar->config.cols + 1;
+
+    moveTo(ar, cell / ar->config.cols + 1, col);
+    setAttr(ar, ch & ~A_CHARTEXT);
+    emit(ar, &c, 1);
+    advanceCursor(ar, col + 1);
+}
+
+// Rewrite the status line only when its text or colours changed
+static void drawStatus(AnsiRenderer *ar, const GameState *gs) {
+    TextLine status[STATUS_PARTS];
+    int parts = formatStatus(gs, status);
+    if (parts == ar->statusParts) {
+        int same = 1;
+        for (int i = 0; i < parts && same; i++) {
+            same = status[i].attr == ar->status[i].attr && strcmp(status[i].text, ar->status[i].text) == 0;
+        }
+        if (same) return;
+    }
+
+    for (int i = 0; i < parts; i++)
+        emitText(ar, status[i].row, status[i].col, status[i].attr, status[i].text);
+    setAttr(ar, A_NORMAL);
+    emitStr(ar, ESC "[K");  // Clear leftovers from a longer message
+    memcpy(ar->status, status, sizeof(status));
+    ar->statusParts = parts;
+}
+
+static void endFrame(AnsiRenderer *ar) {
+    long long frameBytes = (long long)ar->len;
+    ar->bytes += frameBytes;
+    if (frameBytes > ar->maxFrameBytes) ar->maxFrameBytes = frameBytes;
+    flushBuffer(ar);
+}
+
+static void queryTerminalSize(AnsiRenderer *ar) {
+    struct winsize ws;
+    if (ioctl(ar->out, TIOCGWINSZ, &ws) == 0 && ws.ws_row > 0 && ws.ws_col > 0) {
+        ar->termRows = ws.ws_row;
+        ar->termCols = ws.ws_col;
+    }
+}
+
+/* ------------------ RENDERER ------------------*/
+// Top up the input buffer without blocking. Returns the bytes waiting.
+static int fillInput(AnsiRenderer *ar) {
+    if (ar->inputPos > 0) {
+        memmove(ar->input, ar->input + ar->inputPos, (size_t)(ar->inputLen - ar->inputPos));
+        ar->inputLen -= ar->inputPos;
+        ar->inputPos = 0;
+    }
+    if (ar->inputLen < INPUT_BYTES) {
+        ar->reads++;
+        ssize_t n = read(ar->in, ar->input + ar->inputLen, (size_t)(INPUT_BYTES - ar->inputLen));
+        if (n > 0) ar->inputLen += (int)n;
+    }
+    return ar->inputLen;
+}
+
+// Bytes in the escape sequence at the start of s, 0 if it is incomplete
+static int escapeLength(const unsigned char *s, int n) {
+    if (n < 2) return 0;
+    if (s[1] == 'O') return n < 3 ? 0 : 3;  // SS3: F1-F4, arrows in application mode
+    if (s[1] != '[') return 1;              // Lone ESC, the next byte is a key of its own
+    // CSI: parameter and intermediate bytes, then a final byte
+    for (int i = 2; i < n; i++) {
+        if (s[i] >= 0x40 && s[i] <= 0x7e) return i + 1;
+        if (s[i] < 0x20 || s[i] > 0x3f) return i;  // Malformed, end it here
+    }
+    return 0;
+}
+
+static int ansiReadKey(Renderer *r) {
+    AnsiRenderer *ar = (AnsiRenderer *)r;
+
+    if (terminalResized) {
+        terminalResized = 0;
+        r->redraw(r);
+        return RENDER_RESIZED;
+    }
+    for (;;) {
+        if (ar->inputPos == ar->inputLen && fillInput(ar) == 0) return -1;
+        unsigned char c = ar->input[ar->inputPos];
+        if (c != 0x1b) {
+            ar->inputPos++;
+            return c;
+        }
+
+        // Arrow and function keys arrive as escape sequences. The game only
+        // knows letters, so skip the whole sequence rather than let
+        // "ESC [ A" steer left; keys typed after it stay queued.
+        int len = escapeLength(ar->input + ar->inputPos, ar->inputLen - ar->inputPos);
+        if (len == 0) len = escapeLength(ar->input, fillInput(ar));
+        if (len == 0 && !ar->escapeWaited) {
+            ar->escapeWaited = 1;  // The rest may still be on its way
+            return -1;
+        }
+        ar->escapeWaited = 0;
+        if (len == 0) {
+            // Still incomplete after the wait: the Escape key on its own,
+            // like curses reports it. Whatever followed it is read as keys.
+            ar->inputPos++;
+            return c;
+        }
+        ar->inputPos += len;
+    }
+}
+
+static void ansiFlushInput(Renderer *r) {
+    AnsiRenderer *ar = (AnsiRenderer *)r;
+    tcflush(ar->in, TCIFLUSH);
+    ar->inputPos = 0;
+    ar->inputLen = 0;
+    ar->escapeWaited = 0;
+}
+
+// Clear the screen and queue the chrome. It goes out with the next frame,
+// which redraws every cell.
+static void ansiRedraw(Renderer *r) {
+    AnsiRenderer *ar = (AnsiRenderer *)r;
+    queryTerminalSize(ar);
+    ar->attr = ATTR_UNKNOWN;
+    setAttr(ar, A_NORMAL);
+    emitStr(ar, ESC "[2J");
+    ar->cursorRow = -1;
+    ar->cursorCol = -1;
+    ar->statusParts = -1;
+    boardViewInvalidate(&ar->view);
+    drawChrome(ar);
+}
+
+static void ansiDrawFrame(Renderer *r, GameState *gs) {
+    AnsiRenderer *ar = (AnsiRenderer *)r;
+    if (!boardViewBegin(&ar->view, gs)) return;
+    boardViewUpdate(&ar->view, gs, drawCell, ar);
+    drawStatus(ar, gs);
+    endFrame(ar);
+}
+
+static void ansiDrawGameOver(Renderer *r, GameState *gs) {
+    AnsiRenderer *ar = (AnsiRenderer *)r;
+    TextLine lines[GAME_OVER_LINES];
+
+    // Catch up with the last move (or a redraw after resize) in the same write
+    if (boardViewBegin(&ar->view, gs)) {
+        boardViewUpdate(&ar->view, gs, drawCell, ar);
+        drawStatus(ar, gs);
+    }
+    formatGameOver(gs, lines);
+    for (int i = 0; i < GAME_OVER_LINES; i++)
+        emitText(ar, lines[i].row, lines[i].col, lines[i].attr, lines[i].text);
+    endFrame(ar);
+}
+
+static void ansiDrawHud(Renderer *r, const char *text) {
+    AnsiRenderer *ar = (AnsiRenderer *)r;
+    int row = hudRow(&ar->config);
+    if (row >= ar->termRows) return;
+    moveTo(ar, row, 0);
+    emitText(ar, row, 0, ATTR_TEXT, text);
+    if (ar->cursorRow != row) return;  // Text filled the line, nothing left to clear
+    setAttr(ar, A_NORMAL);
+    emitStr(ar, ESC "[K");
+}
+
+static void restoreTerminal(void) {
+    unguardTerminal();
+    signal(SIGWINCH, SIG_DFL);
+}
+
+static void ansiDestroy(Renderer *r) {
+    AnsiRenderer *ar = (AnsiRenderer *)r;
+    restoreTerminal();
+    if (ar->stats) {
+        printRenderStats(r->name, &ar->view, ar->bytes, ar->maxFrameBytes, ar->writes, ar->reads);
+    }
+    boardViewFree(&ar->view);
+    free(ar->buf);
+    free(ar);
+}
+
+Renderer *createAnsiRenderer(const GameConfig *config, const RenderOptions *opts) {
+    AnsiRenderer *ar = calloc(1, sizeof(*ar));
+    if (!ar || !boardViewInit(&ar->view, config, opts->boostRefreshFrames)) {
+        fprintf(stderr, "Not enough memory for a %dx%d board\n", config->cols, config->rows);
+        free(ar);
+        return NULL;
+    }
+    ar->base.name = "ansi";
+    ar->base.readKey = ansiReadKey;
+    ar->base.flushInput = ansiFlushInput;
+    ar->base.redraw = ansiRedraw;
+    ar->base.drawFrame = ansiDrawFrame;
+    ar->base.drawGameOver = ansiDrawGameOver;
+    ar->base.drawHud = ansiDrawHud;
+    ar->base.destroy = ansiDestroy;
+    ar->config = *config;
+    ar->stats = opts->stats;
+    ar->in = STDIN_FILENO;
+    ar->out = STDOUT_FILENO;
+
+    ar->cap = (size_t)ar->view.cells * FRAME_BYTES_PER_CELL + FRAME_SLACK_BYTES;
+    ar->buf = malloc(ar->cap);
+    if (!ar->buf) {
+        fprintf(stderr, "Not enough memory for a %dx%d board\n", config->cols, config->rows);
+        boardViewFree(&ar->view);
+        free(ar);
+        return NULL;
+    }
+
+    if (!isatty(ar->in) || !isatty(ar->out) || tcgetattr(ar->in, &ar->savedTermios) != 0) {
+        fprintf(stderr, "The ansi renderer needs a terminal\n");
+        boardViewFree(&ar->view);
+        free(ar->buf);
+        free(ar);
+        return NULL;
+    }
+
+    // The bordered board and the status line must fit on screen
+    queryTerminalSize(ar);
+    if (ar->termRows < config->rows + 4 || ar->termCols < config->cols + 2) {
+        fprintf(stderr, "Terminal is %dx%d but a %dx%d board needs at least %dx%d\n",
+                ar->termCols, ar->termRows, config->cols, config->rows, config->cols + 2, config->rows + 4);
+        boardViewFree(&ar->view);
+        free(ar->buf);
+        free(ar);
+        return NULL;
+    }
+
+    // Raw-ish keyboard: no line buffering or echo, reads never block.
+    // Ctrl-C still raises SIGINT, which restores all this before dying.
+    guardTerminal(ar);
+    struct termios raw = ar->savedTermios;
+    raw.c_lflag &= (tcflag_t)~(ICANON | ECHO);
+    raw.c_cc[VMIN] = 0;
+    raw.c_cc[VTIME] = 0;
+    tcsetattr(ar->in, TCSANOW, &raw);
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = onWinch;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGWINCH, &sa, NULL);
+
+    // glyph_table is normally filled in by init_colors(), which needs curses
+    build_glyph_table();
+
+    // Alternate screen with the cursor hidden, restored by destroy or the guard
+    emitStr(ar, ESC "[?1049h" ESC "[?25l");
+    flushBuffer(ar);
+    ar->writes = 0;
+    ansiRedraw(&ar->base);
+    return &ar->base;
+}
+
+#endif // _WIN32
@@ -0,0 +1,211 @@
+// Curses renderer: the board in its own bordered window, text on stdscr,
+// every frame staged with wnoutrefresh() and written out by one doupdate(),
+// which reaches the terminal as a single write() unless it outgrows the
+// screen-sized output buffer ncurses keeps (full repaints of big terminals).
+#include "render.h"
+#include <stdio.h>
+#include <stdlib.h>
+#ifdef _WIN32
+    #include "PDCurses/curses.h"  // Use local PDCurses headers
+#else
+    #include <ncurses.h> // Linux/Mac
+#endif
+
+typedef struct {
+    Renderer base;
+    GameConfig config;
+    WINDOW *gameWin;
+    BoardView view;
+    int stats;
+    // ncurses writes straight to the terminal's file descriptor, so bytes
+    // and syscalls come from the kernel's per-process counters, which in
+    // interactive mode are all terminal I/O
+    IoCounters ioStart;
+    int haveIo;
+    long long maxFrameBytes;
+} CursesRenderer;
+
+static void drawText(const TextLine *line) {
+    attrset(line->attr);
+    mvaddstr(line->row, line->col, line->text);
+    attrset(A_NORMAL);
+}
+
+// Draw the border and instructions panel. They never change, so this only
+// runs at startup, on restart and after a terminal resize.
+static void drawChrome(CursesRenderer *cr) {
+    apply_border_color(cr->gameWin);
+    box(cr->gameWin, 0, 0);
+    remove_all_colors(cr->gameWin);
+
+    apply_text_color(NULL);
+    for (int i = 0; i < INSTRUCTION_ROWS; i++) {
+        if (instructionRows[i])
+            mvaddstr(instructionsTop() + i, instructionsLeft(&cr->config), instructionRows[i]);
+    }
+    remove_all_colors(NULL);
+}
+
+// Push staged window changes to the terminal in one pass
+static void flushScreen(CursesRenderer *cr) {
+    IoCounters before, after;
+    int measure = cr->stats && cr->haveIo && readIoCounters(&before);
+    doupdate();
+    if (measure && readIoCounters(&after)) {
+        long long bytes = after.bytes - before.bytes;
+        if (bytes > cr->maxFrameBytes) cr->maxFrameBytes = bytes;
+    }
+}
+
+static void drawCell(void *ctx, int cell, GlyphId glyph) {
+    CursesRenderer *cr = ctx;
+    mvwaddch(cr->gameWin, cell / cr->config.cols + 1, cell % cr->config.cols + 1, glyph_cell(glyph));
+}
+
+static int cursesReadKey(Renderer *r) {
+    int ch = getch();
+    if (ch == ERR) return -1;
+    if (ch == KEY_RESIZE) {
+        r->redraw(r);
+        return RENDER_RESIZED;
+    }
+    return ch;
+}
+
+static void cursesFlushInput(Renderer *r) {
+    (void)r;
+    flushinp();
+}
+
+static void cursesRedraw(Renderer *r) {
+    CursesRenderer *cr = (CursesRenderer *)r;
+    werase(cr->gameWin);
+    clear();
+    boardViewInvalidate(&cr->view);
+    drawChrome(cr);
+}
+
+static void cursesDrawFrame(Renderer *r, GameState *gs) {
+    CursesRenderer *cr = (CursesRenderer *)r;
+    TextLine status[STATUS_PARTS];
+
+    // Skip drawing and doupdate() entirely when nothing visible changed
+    if (!boardViewBegin(&cr->view, gs)) return;
+    boardViewUpdate(&cr->view, gs, drawCell, cr);
+
+    // Clear the line first to remove any leftover characters from a longer message
+    move(gs->config.rows + 3, 0);
+    clrtoeol();
+    int parts = formatStatus(gs, status);
+    for (int i = 0; i < parts; i++) drawText(&status[i]);
+
+    // Stage stdscr (status line) under the board window, then write both out
+    wnoutrefresh(stdscr);
+    wnoutrefresh(cr->gameWin);
+    flushScreen(cr);
+}
+
+// Game over message over the final board
+static void cursesDrawGameOver(Renderer *r, GameState *gs) {
+    CursesRenderer *cr = (CursesRenderer *)r;
+    TextLine lines[GAME_OVER_LINES];
+
+    cursesDrawFrame(r, gs);  // Catch up with the last move (or a redraw after resize)
+    formatGameOver(gs, lines);
+    for (int i = 0; i < GAME_OVER_LINES; i++) drawText(&lines[i]);
+
+    wnoutrefresh(stdscr);
+    flushScreen(cr);
+}
+
+static void cursesDrawHud(Renderer *r, const char *text) {
+    CursesRenderer *cr = (CursesRenderer *)r;
+    int row = hudRow(&cr->config);
+    if (row >= LINES) return;
+    move(row, 0);
+    clrtoeol();
+    attrset(ATTR_TEXT);
+    mvaddnstr(row, 0, text, COLS);
+    attrset(A_NORMAL);
+}
+
+static void cursesDestroy(Renderer *r) {
+    CursesRenderer *cr = (CursesRenderer *)r;
+    IoCounters end;
+    int haveEnd = cr->stats && cr->haveIo && readIoCounters(&end);
+
+    delwin(cr->gameWin);
+    endwin();
+    if (cr->stats) {
+        if (haveEnd) {
+            printRenderStats(r->name, &cr->view, end.bytes - cr->ioStart.bytes, cr->maxFrameBytes,
+                             end.writes - cr->ioStart.writes, end.reads - cr->ioStart.reads);
+        } else {
+            fprintf(stderr, "Terminal I/O counts are not available on this platform\n");
+        }
+    }
+    boardViewFree(&cr->view);
+    free(cr);
+}
+
+Renderer *createCursesRenderer(const GameConfig *config, const RenderOptions *opts) {
+    CursesRenderer *cr = calloc(1, sizeof(*cr));
+    if (!cr || !boardViewInit(&cr->view, config, opts->boostRefreshFrames)) {
+        fprintf(stderr, "Not enough memory for a %dx%d board\n", config->cols, config->rows);
+        free(cr);
+        return NULL;
+    }
+    cr->base.name = "curses";
+    cr->base.readKey = cursesReadKey;
+    cr->base.flushInput = cursesFlushInput;
+    cr->base.redraw = cursesRedraw;
+    cr->base.drawFrame = cursesDrawFrame;
+    cr->base.drawGameOver = cursesDrawGameOver;
+    cr->base.drawHud = cursesDrawHud;
+    cr->base.destroy = cursesDestroy;
+    cr->config = *config;
+    cr->stats = opts->stats;
+
+    initscr();
+    cbreak();
+    noecho();
+    nodelay(stdscr, TRUE);
+    curs_set(0);
+    keypad(stdscr, TRUE);
+    if (!init_colors()) {
+        printw("Colors not supported on this terminal\n");
+        refresh();
+        nodelay(stdscr, FALSE);
+        getch();
+        endwin();
+        boardViewFree(&cr->view);
+        free(cr);
+        return NULL;
+    }
+
+    // The bordered board and the status line must fit on screen
+    if (LINES < config->rows + 4 || COLS < config->cols + 2) {
+        endwin();
+        fprintf(stderr, "Terminal is %dx%d but a %dx%d board needs at least %dx%d\n",
+                COLS, LINES, config->cols, config->rows, config->cols + 2, config->rows + 4);
+        boardViewFree(&cr->view);
+        free(cr);
+        return NULL;
+    }
+
+#ifdef NCURSES_VERSION
+    // Until the screen has been suspended once, ncurses treats it as not yet
+    // running and flushes after every cursor move, so a doupdate() goes out
+    // in several write() calls. One endwin() and refresh() cycle here, while
+    // the screen is still blank, leaves it running and each doupdate()
+    // buffered into a single write.
+    endwin();
+    refresh();
+#endif
+
+    // Create the border window once
+    cr->gameWin = newwin(config->rows + 2, config->cols + 2, 0, 0);
+    if (cr->stats) cr->haveIo = readIoCounters(&cr->ioStart);
+    cursesRedraw(&cr->base);
+    return &cr->base;
+}
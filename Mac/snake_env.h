@@ -0,0 +1,179 @@
+#ifndef SNAKE_ENV_H
+#define SNAKE_ENV_H
+
+// Reinforcement-learning environment: the game rules behind a plain C ABI,
+// with no curses and no globals, so it can be loaded from any language that
+// calls C (ctypes, cffi, JNI...) and any number of environments can run side
+// by side. Built as libsnakeenv.a and a shared library by "make lib".
+//
+// One step is one snake move: the action steers, then the game advances
+// frame by frame (spawns, timers, expiries) until the snake has moved.
+// Observations are written straight into a buffer the caller owns.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef _WIN32
+    #define SNAKE_ENV_API __declspec(dllexport)
+#else
+    #define SNAKE_ENV_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Actions. Turning back onto the snake is ignored, like in the game.
+#define SNAKE_ACTION_UP 0
+#define SNAKE_ACTION_DOWN 1
+#define SNAKE_ACTION_LEFT 2
+#define SNAKE_ACTION_RIGHT 3
+#define SNAKE_ACTION_KEEP 4   // Keep the current direction
+#define SNAKE_ACTION_COUNT 5
+
+// Cell values in SNAKE_LAYOUT_CELLS observations
+#define SNAKE_OBS_EMPTY 0
+#define SNAKE_OBS_BODY 1
+#define SNAKE_OBS_FOOD 2
+#define SNAKE_OBS_TEMP_FOOD 3         // Worth 1
+#define SNAKE_OBS_TEMP_FOOD_DOUBLE 4  // Worth 2
+#define SNAKE_OBS_TEMP_FOOD_TRIPLE 5  // Worth 3
+#define SNAKE_OBS_SPECIAL 6           // Speed boost
+#define SNAKE_OBS_DEATH 7             // Ends the game when eaten
+#define SNAKE_OBS_HEAD 8
+#define SNAKE_OBS_WALL 9              // Outside the board, only in a crop
+
+// Observation layouts, chosen with snakeEnvSetObservation(). Cells are in
+// row-major order over the board, or over a square crop centred on the head.
+#define SNAKE_LAYOUT_CELLS 0  // One byte per cell with the SNAKE_OBS_* values above (default)
+#define SNAKE_LAYOUT_BITS 1   // SNAKE_PLANE_BITS bit planes, then scalars as bytes 0-255
+#define SNAKE_LAYOUT_FLOAT 2  // SNAKE_PLANE_COUNT float planes, then scalars as floats
+
+// Planes. Bit planes are (cells + 7) / 8 bytes each, cell i in bit i % 8 of
+// byte i / 8. Float planes hold 1.0 where the bit would be set, except:
+#define SNAKE_PLANE_HEAD 0
+#define SNAKE_PLANE_BODY 1              // Includes the head
+#define SNAKE_PLANE_FOOD 2
+#define SNAKE_PLANE_TEMP_FOOD 3         // Float: time left as a fraction of its lifetime
+#define SNAKE_PLANE_TEMP_FOOD_DOUBLE 4  // Float: time left, as above
+#define SNAKE_PLANE_TEMP_FOOD_TRIPLE 5  // Float: time left, as above
+#define SNAKE_PLANE_SPECIAL 6
+#define SNAKE_PLANE_DEATH 7
+#define SNAKE_PLANE_WALL 8              // Outside the board, only in a crop
+#define SNAKE_PLANE_BITS 9
+#define SNAKE_PLANE_BODY_AGE 9          // Float only, see below
+#define SNAKE_PLANE_COUNT 10
+
+// The body age plane holds, on every body cell, 1 - age / segments, age
+// being the moves since the head entered the cell and segments the cells
+// the body covers: 1 on the head, 1 / segments on the tail. Times segments
+// it is the moves until the cell is free again, unless the snake grows.
+// Every value changes on every move, so this plane costs a write per
+// segment per step.
+
+// Scalars after the planes, in [0, 1]. There are SNAKE_SCALAR_TEMP_FOOD +
+// maxTempFood of them.
+#define SNAKE_SCALAR_BOOST 0      // Speed boost time left as a fraction of its duration
+#define SNAKE_SCALAR_DIRECTION 1  // Four entries, one-hot: up, down, left, right
+#define SNAKE_SCALAR_LENGTH 5     // Snake length over the board's cell count
+#define SNAKE_SCALAR_TEMP_FOOD 6  // One entry per temp food slot: time left as a fraction of
+                                  // its lifetime, 0 when empty. Temp food fills the slots
+                                  // in spawn order; when one goes, the last moves into its slot.
+
+typedef struct {
+    int32_t cols;
+    int32_t rows;
+    int32_t maxFood;
+    int32_t maxTempFood;
+    int32_t maxDeathItems;
+} SnakeEnvConfig;
+
+typedef struct {
+    int32_t layout;  // SNAKE_LAYOUT_*
+    int32_t crop;    // 0 for the whole board, or the odd side of a window centred on the head
+    int32_t inPlace; // 1 to update observations in place, see below; 0 to write them whole
+} SnakeObsSpec;
+
+typedef struct {
+    float reward;   // Score gained by this step
+    int32_t done;   // Game over; reset before stepping again
+    int32_t score;  // Score so far this game
+} SnakeEnvStep;
+
+typedef struct SnakeEnv SnakeEnv;
+
+// The game's own defaults: a 40x20 board and its item caps
+SNAKE_ENV_API SnakeEnvConfig snakeEnvDefaultConfig(void);
+
+// Returns NULL if the config is out of range or memory runs out
+SNAKE_ENV_API SnakeEnv *snakeEnvCreate(const SnakeEnvConfig *config);
+SNAKE_ENV_API void snakeEnvDestroy(SnakeEnv *env);
+
+// Pick the observation layout. Returns 0, keeping the old one, if the
+// spec is invalid. Takes effect from the next observation written.
+SNAKE_ENV_API int32_t snakeEnvSetObservation(SnakeEnv *env, const SnakeObsSpec *spec);
+
+// Bytes in an observation in the current layout
+SNAKE_ENV_API size_t snakeEnvObservationSize(const SnakeEnv *env);
+
+// Without inPlace, every reset and step writes the whole observation into
+// obs, so any buffer will do. With inPlace set, obs must be the buffer that
+// received the game's last observation, left untouched since: only the
+// cells that changed are rewritten. The first observation after a reset or
+// a layout change is written whole, and steps with a NULL obs are caught
+// up on the next one. A crop is always written whole, all crop * crop
+// cells every call, since the window moves with the head: inPlace only
+// saves work on whole-board observations.
+
+// Start a new game. The same seed and actions replay the same game. obs
+// may be NULL to skip the observation.
+SNAKE_ENV_API void snakeEnvReset(SnakeEnv *env, uint64_t seed, uint8_t *obs);
+
+// Apply action and play until the snake has moved or the game is over.
+// Stepping a finished game changes nothing and reports done again.
+SNAKE_ENV_API SnakeEnvStep snakeEnvStep(SnakeEnv *env, int32_t action, uint8_t *obs);
+
+// Write the whole current observation into obs
+SNAKE_ENV_API void snakeEnvObserve(const SnakeEnv *env, uint8_t *obs);
+
+// Batch environment: count games stepped together by one call, with
+// actions, observations and results in flat arrays indexed by game. A game
+// that ends is reset in place during the same step: its done flag and
+// reward are for the step that ended it, its observation is the first one
+// of the next game. Every slot plays its own seeded sequence of games, so
+// runs replay exactly whatever the batch size: after a reset with seed,
+// episode e of slot i (counting from 0) is the game snakeEnvReset() starts
+// with mixSeed(mixSeed(seed + i * 0x9E3779B97F4A7C15) + e), see rng.h.
+//
+// This is a batch API, not a vectorised rule engine. Steering, the move
+// timer, the event check and the wall check run as one vectorised loop over
+// all games; the move itself, item and body checks, events and observations
+// run game by game, as in snakeEnvStep(). Throughput is about that of
+// calling snakeEnvStep() on count separate environments, ahead of it when
+// observations are skipped. Both fall behind a single game once the boards
+// no longer fit in cache (thousands of games on the default board).
+typedef struct SnakeVecEnv SnakeVecEnv;
+
+SNAKE_ENV_API SnakeVecEnv *snakeVecEnvCreate(const SnakeEnvConfig *config, int32_t count);
+SNAKE_ENV_API void snakeVecEnvDestroy(SnakeVecEnv *venv);
+SNAKE_ENV_API int32_t snakeVecEnvCount(const SnakeVecEnv *venv);
+
+// Observation layout for every game, see snakeEnvSetObservation()
+SNAKE_ENV_API int32_t snakeVecEnvSetObservation(SnakeVecEnv *venv, const SnakeObsSpec *spec);
+
+// Bytes in one game's observation; obs arrays hold count of them back to back
+SNAKE_ENV_API size_t snakeVecEnvObservationSize(const SnakeVecEnv *venv);
+
+// Start a new game in every slot. obs may be NULL.
+SNAKE_ENV_API void snakeVecEnvReset(SnakeVecEnv *venv, uint64_t seed, uint8_t *obs);
+
+// One move in every game. actions, rewards and dones hold count entries;
+// obs and scores (score of each game when this step ended) may be NULL.
+SNAKE_ENV_API void snakeVecEnvStep(SnakeVecEnv *venv, const int32_t *actions, uint8_t *obs,
+                                   float *rewards, int32_t *dones, int32_t *scores);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SNAKE_ENV_H
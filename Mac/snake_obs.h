@@ -0,0 +1,44 @@
+#ifndef SNAKE_OBS_H
+#define SNAKE_OBS_H
+
+// Observation encoders behind the environment library (see snake_env.h for
+// the layouts). An encoder keeps its caller's buffer up to date from the
+// game's dirty cell list and the head's moves, so a step rewrites only what
+// changed instead of the whole board.
+
+#include "game.h"
+#include "snake_env.h"
+
+typedef struct {
+    SnakeObsSpec spec;
+    int width;         // Plane size: the board, or the crop window
+    int height;
+    size_t planeBytes; // One bit plane in SNAKE_LAYOUT_BITS
+    size_t scalars;    // Scalars after the planes
+    size_t size;       // Bytes in an observation
+    int written;       // An observation was written since the reset, so in place updates can follow
+    uint32_t lastHead; // Head cell in that observation
+    uint32_t *laidAt;  // Move on which the head entered each cell, body age is moves minus this
+    uint32_t moves;    // Moves seen since the reset
+    uint32_t trackedHead;
+} ObsEncoder;
+
+// Returns 0 if the spec is invalid or memory runs out
+int obsEncoderInit(ObsEncoder *enc, const GameState *gs, const SnakeObsSpec *spec);
+void obsEncoderFree(ObsEncoder *enc);
+
+// Call after resetGameState()
+void obsEncoderReset(ObsEncoder *enc, const GameState *gs);
+
+// Call after every step, whether or not an observation is written
+void obsEncoderTrack(ObsEncoder *enc, const GameState *gs);
+
+// Bring obs up to date. With spec.inPlace set, obs holds the observation
+// the last call wrote and only the changes are written; otherwise all of it
+// is. Clears the game's dirty cells.
+void obsEncode(ObsEncoder *enc, GameState *gs, uint8_t *obs);
+
+// Write a complete observation without touching the encoder or the game
+void obsEncodeFull(const ObsEncoder *enc, const GameState *gs, uint8_t *obs);
+
+#endif // SNAKE_OBS_H
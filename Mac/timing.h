@@ -0,0 +1,17 @@
+#ifndef TIMING_H
+#define TIMING_H
+
+#include <stdint.h>
+
+// Monotonic clock in nanoseconds. Only differences between two readings are
+// meaningful; the clock never jumps when the wall clock is changed.
+uint64_t monotonicNs(void);
+
+#define WAIT_FOREVER (-1)
+
+// Block until the keyboard (stdin) has input or timeoutNs passes, using no
+// CPU meanwhile. Returns 1 when input is waiting, 0 on timeout or when a
+// signal (such as a terminal resize) interrupted the wait.
+int waitForInput(int64_t timeoutNs);
+
+#endif // TIMING_H
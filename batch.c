@@ -0,0 +1,310 @@
+// Batch runner: a fixed pool of workers, each with a Chase-Lev work-stealing
+// deque of game chunks, its own GameState, RNG and score histogram.
+#ifndef _WIN32
+    #define _POSIX_C_SOURCE 200809L  // pthreads, sched_yield and sysconf under -std=c11
+#endif
+#include "batch.h"
+#include "headless.h"
+#include "timing.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef _WIN32
+    #define NOMINMAX
+    #include <windows.h>
+#else
+    #include <unistd.h>
+#endif
+
+#define CACHE_LINE 64
+#define CHUNKS_PER_WORKER 16  // Enough chunks to even out long and short games
+#define STEAL_STREAM_BASE 16  // Rng streams for victim picking, clear of the game streams
+
+int onlineCpuCount(void) {
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors > 0 ? (int)info.dwNumberOfProcessors : 1;
+#else
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int)n : 1;
+#endif
+}
+
+/* ------------------ WORK-STEALING DEQUE ------------------*/
+// Chase-Lev deque of chunk indices. The owner pushes and pops at the bottom,
+// thieves take from the top. top and bottom sit on separate cache lines so
+// the owner and thieves do not false-share.
+typedef struct {
+    _Alignas(CACHE_LINE) atomic_long top;
+    _Alignas(CACHE_LINE) atomic_long bottom;
+    int *tasks;
+    long capacity;
+} TaskDeque;
+
+static void dequePush(TaskDeque *dq, int task) {
+    long b = atomic_load_explicit(&dq->bottom, memory_order_relaxed);
+    dq->tasks[b % dq->capacity] = task;
+    atomic_thread_fence(memory_order_release);
+    atomic_store_explicit(&dq->bottom, b + 1, memory_order_relaxed);
+}
+
+static int dequePop(TaskDeque *dq, int *task) {
+    long b = atomic_load_explicit(&dq->bottom, memory_order_relaxed) - 1;
+    atomic_store_explicit(&dq->bottom, b, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    long t = atomic_load_explicit(&dq->top, memory_order_relaxed);
+
+    if (t > b) {
+        // Empty: restore bottom
+        atomic_store_explicit(&dq->bottom, b + 1, memory_order_relaxed);
+        return 0;
+    }
+
+    *task = dq->tasks[b % dq->capacity];
+    if (t == b) {
+        // Last item: race any thief for it
+        int won = atomic_compare_exchange_strong_explicit(&dq->top, &t, t + 1,
+                      memory_order_seq_cst, memory_order_relaxed);
+        atomic_store_explicit(&dq->bottom, b + 1, memory_order_relaxed);
+        return won;
+    }
+    return 1;
+}
+
+static int dequeSteal(TaskDeque *dq, int *task) {
+    long t = atomic_load_explicit(&dq->top, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    long b = atomic_load_explicit(&dq->bottom, memory_order_acquire);
+    if (t >= b) return 0;
+
+    *task = dq->tasks[t % dq->capacity];
+    return atomic_compare_exchange_strong_explicit(&dq->top, &t, t + 1,
+               memory_order_seq_cst, memory_order_relaxed);
+}
+
+/* ------------------ WORKERS ------------------*/
+typedef struct BatchRun BatchRun;
+
+// Per-worker state. Cache-line alignment keeps each worker's counters and
+// deque indices off its neighbours' lines.
+typedef struct {
+    _Alignas(CACHE_LINE) TaskDeque deque;
+    BatchRun *run;
+    GameState *game;
+    Rng rng;  // Picks steal victims, never touches game outcomes
+    int id;
+    pthread_t thread;
+
+    unsigned long long games;
+    unsigned long long frames;
+    unsigned long long moves;
+    unsigned long long capped;
+    unsigned long long steals;
+    long long scoreSum;
+    unsigned long long hist[BATCH_HIST_BINS];
+} Worker;
+
+struct BatchRun {
+    const BatchOptions *opts;
+    Worker *workers;
+    int workerCount;
+    int chunkSize;
+    _Alignas(CACHE_LINE) atomic_int remaining;  // Chunks not yet finished
+};
+
+static void runChunk(Worker *w, int chunk) {
+    const BatchOptions *opts = w->run->opts;
+    int first = chunk * w->run->chunkSize;
+    int last = first + w->run->chunkSize;
+    if (last > opts->games) last = opts->games;
+
+    for (int i = first; i < last; i++) {
+        GameResult r = playAutopilotGame(w->game, headlessGameSeed(opts->seed, (uint32_t)i),
+                                         opts->maxFrames);
+        int bin = r.score < 0 ? 0 : r.score;
+        if (bin >= BATCH_HIST_BINS) bin = BATCH_HIST_BINS - 1;
+
+        w->hist[bin]++;
+        w->games++;
+        w->frames += (unsigned long long)r.frames;
+        w->moves += (unsigned long long)r.moves;
+        w->capped += (unsigned long long)r.capped;
+        w->scoreSum += r.score;
+    }
+}
+
+// Try random victims first, then sweep every other worker once
+static int stealChunk(Worker *w, int *chunk) {
+    BatchRun *run = w->run;
+    if (run->workerCount < 2) return 0;
+
+    for (int attempt = 0; attempt < run->workerCount; attempt++) {
+        int victim = (int)rngBelow(&w->rng, (uint32_t)run->workerCount);
+        if (victim != w->id && dequeSteal(&run->workers[victim].deque, chunk)) return 1;
+    }
+    for (int i = 1; i < run->workerCount; i++) {
+        int victim = (w->id + i) % run->workerCount;
+        if (dequeSteal(&run->workers[victim].deque, chunk)) return 1;
+    }
+    return 0;
+}
+
+static void *workerMain(void *arg) {
+    Worker *w = arg;
+    BatchRun *run = w->run;
+    int chunk;
+
+    while (atomic_load_explicit(&run->remaining, memory_order_acquire) > 0) {
+        if (dequePop(&w->deque, &chunk)) {
+            runChunk(w, chunk);
+        } else if (stealChunk(w, &chunk)) {
+            w->steals++;
+            runChunk(w, chunk);
+        } else {
+            sched_yield();
+            continue;
+        }
+        atomic_fetch_sub_explicit(&run->remaining, 1, memory_order_release);
+    }
+    return NULL;
+}
+
+/* ------------------ RESULTS ------------------*/
+// Smallest score whose cumulative count reaches fraction of all games
+static int histPercentile(const unsigned long long *hist, unsigned long long games, double fraction) {
+    unsigned long long target = (unsigned long long)(fraction * (double)games);
+    unsigned long long seen = 0;
+    if (target == 0) target = 1;
+    for (int i = 0; i < BATCH_HIST_BINS; i++) {
+        seen += hist[i];
+        if (seen >= target) return i;
+    }
+    return BATCH_HIST_BINS - 1;
+}
+
+static void printResults(const GameConfig *config, const BatchRun *run, double seconds) {
+    unsigned long long hist[BATCH_HIST_BINS];
+    unsigned long long games = 0, frames = 0, moves = 0, capped = 0, steals = 0;
+    long long scoreSum = 0;
+
+    // Merge per-worker results. Plain sums, so the order does not matter.
+    memset(hist, 0, sizeof(hist));
+    for (int w = 0; w < run->workerCount; w++) {
+        const Worker *wk = &run->workers[w];
+        for (int i = 0; i < BATCH_HIST_BINS; i++) hist[i] += wk->hist[i];
+        games += wk->games;
+        frames += wk->frames;
+        moves += wk->moves;
+        capped += wk->capped;
+        steals += wk->steals;
+        scoreSum += wk->scoreSum;
+    }
+
+    int minScore = 0, maxScore = 0;
+    for (int i = 0; i < BATCH_HIST_BINS; i++) {
+        if (hist[i]) { minScore = i; break; }
+    }
+    for (int i = BATCH_HIST_BINS - 1; i >= 0; i--) {
+        if (hist[i]) { maxScore = i; break; }
+    }
+
+    if (!run->opts->quiet) {
+        printf("score histogram:\n");
+        for (int i = 0; i < BATCH_HIST_BINS; i++) {
+            if (!hist[i]) continue;
+            printf("  %4d%s %llu\n", i, i == BATCH_HIST_BINS - 1 ? "+" : " ", hist[i]);
+        }
+    }
+    printf("games: %llu (%llu hit the frame cap)\n", games, capped);
+    printf("board: %dx%d, seed: %llu\n", config->cols, config->rows,
+           (unsigned long long)run->opts->seed);
+    printf("score: mean %.2f, min %d, p50 %d, p90 %d, p99 %d, max %d%s\n",
+           games ? (double)scoreSum / (double)games : 0.0, minScore,
+           histPercentile(hist, games, 0.50), histPercentile(hist, games, 0.90),
+           histPercentile(hist, games, 0.99), maxScore,
+           hist[BATCH_HIST_BINS - 1] ? "+" : "");
+    printf("frames: %llu, moves: %llu\n", frames, moves);
+    printf("threads: %d, chunk: %d games, steals: %llu, elapsed: %.3f s\n",
+           run->workerCount, run->chunkSize, steals, seconds);
+    printf("games/sec: %.0f\n", (double)games / seconds);
+    printf("ticks/sec: %.0f\n", (double)frames / seconds);
+    printf("moves/sec: %.0f\n", (double)moves / seconds);
+}
+
+/* ------------------ RUNNER ------------------*/
+int runBatch(const GameConfig *config, const BatchOptions *opts) {
+    BatchRun run;
+    int threads = opts->threads > 0 ? opts->threads : onlineCpuCount();
+    if (threads > opts->games) threads = opts->games;
+
+    int chunkSize = opts->games / (threads * CHUNKS_PER_WORKER);
+    if (chunkSize < 1) chunkSize = 1;
+    int chunks = (opts->games + chunkSize - 1) / chunkSize;
+    int perWorker = (chunks + threads - 1) / threads;
+
+    // Over-allocate by one line so the worker array can be aligned by hand
+    void *workerBlock = calloc((size_t)threads + 1, sizeof(Worker));
+    int *taskBlock = malloc((size_t)threads * (size_t)perWorker * sizeof(int));
+    if (!workerBlock || !taskBlock) {
+        fprintf(stderr, "Not enough memory for %d workers\n", threads);
+        free(workerBlock);
+        free(taskBlock);
+        return 1;
+    }
+
+    memset(&run, 0, sizeof(run));
+    run.opts = opts;
+    run.workers = (Worker *)(((uintptr_t)workerBlock + CACHE_LINE - 1) & ~(uintptr_t)(CACHE_LINE - 1));
+    run.workerCount = threads;
+    run.chunkSize = chunkSize;
+    atomic_init(&run.remaining, chunks);
+
+    int ok = 1;
+    for (int i = 0; i < threads; i++) {
+        Worker *w = &run.workers[i];
+        atomic_init(&w->deque.top, 0);
+        atomic_init(&w->deque.bottom, 0);
+        w->deque.tasks = taskBlock + (size_t)i * perWorker;
+        w->deque.capacity = perWorker;
+        w->run = &run;
+        w->id = i;
+        rngSeed(&w->rng, opts->seed, STEAL_STREAM_BASE + (uint64_t)i);
+        w->game = createGameState(config, 1);
+        if (!w->game) ok = 0;
+    }
+
+    // Deal chunks round-robin so every worker starts with local work
+    for (int c = 0; c < chunks; c++)
+        dequePush(&run.workers[c % threads].deque, c);
+
+    if (!ok) {
+        fprintf(stderr, "Cannot create a %dx%d game per worker\n", config->cols, config->rows);
+    } else {
+        uint64_t start = monotonicNs();
+        int started = 1;
+        for (int i = 1; i < threads; i++) {
+            if (pthread_create(&run.workers[i].thread, NULL, workerMain, &run.workers[i]) != 0) {
+                // The remaining workers steal this worker's share
+                fprintf(stderr, "Could not start worker %d, continuing with %d\n", i, started);
+                break;
+            }
+            started++;
+        }
+        workerMain(&run.workers[0]);
+        for (int i = 1; i < started; i++)
+            pthread_join(run.workers[i].thread, NULL);
+        uint64_t elapsed = monotonicNs() - start;
+
+        printResults(config, &run, elapsed > 0 ? (double)elapsed / 1e9 : 1e-9);
+    }
+
+    for (int i = 0; i < threads; i++)
+        destroyGameState(run.workers[i].game);
+    free(taskBlock);
+    free(workerBlock);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,28 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+// Multi-threaded batch runner. Spreads independent autopilot games over a
+// pool of workers that balance load by stealing from each other's deques.
+// Every game is seeded from its index, and per-worker results are merged by
+// plain summation, so the output never depends on the thread count.
+
+#include "game.h"
+
+#define BATCH_HIST_BINS 1024  // Score histogram bins, the last one collects overflow
+
+typedef struct {
+    int games;       // Total games to play
+    int threads;     // Worker threads, 0 = one per online CPU
+    int maxFrames;   // Per-game frame cap
+    int quiet;       // Skip the histogram dump
+    uint64_t seed;   // Base seed, game i uses headlessGameSeed(seed, i)
+} BatchOptions;
+
+// Number of CPUs available to the process, at least 1
+int onlineCpuCount(void);
+
+// Play every game, print merged statistics and throughput to stdout.
+// Returns 0 on success, 1 on setup failure.
+int runBatch(const GameConfig *config, const BatchOptions *opts);
+
+#endif // BATCH_H
@@ -0,0 +1,317 @@
+// Checks of the environment library's observations, run by "make test".
+// Plays games in every layout and checks that:
+//   - every float plane value and scalar lies in [0, 1]
+//   - the body age plane numbers the segments 1 to n over n from the tail
+//   - the observation updated in place matches a full write of the same state
+//   - every slot of a batch environment, at several batch sizes, replays
+//     exactly like a single environment given the slot's seeds and actions
+// Prints one line per case and exits non-zero if any check failed.
+#include "snake_env.h"
+#include "rng.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TEST_STEPS 200000
+#define VEC_GAMES 8
+#define VEC_STEPS 20000
+#define REPLAY_STEPS 20000
+#define REPLAY_SEED 11
+
+typedef struct {
+    const char *name;
+    SnakeEnvConfig config;
+} TestBoard;
+
+static const char *const layoutNames[] = { "cells", "bits", "float" };
+
+// Random action, mostly keeping the direction
+static int32_t randomAction(Rng *rng) {
+    uint32_t r = rngBelow(rng, 8);
+    return r < SNAKE_ACTION_COUNT - 1 ? (int32_t)r : SNAKE_ACTION_KEEP;
+}
+
+// Steer clear of walls, the body and death items, going straight on most of
+// the time, so games run long enough for long snakes, boosts and expiring
+// temp food. cells is a whole-board
+// SNAKE_LAYOUT_CELLS observation, dir the snake's direction.
+static int32_t safeAction(const uint8_t *cells, const SnakeEnvConfig *config, int32_t *dir, Rng *rng) {
+    static const int dx[] = { 0, 0, -1, 1 };
+    static const int dy[] = { -1, 1, 0, 0 };
+    int head = 0;
+    while (cells[head] != SNAKE_OBS_HEAD) head++;
+
+    // Straight on first, then the two turns in random order
+    int32_t options[3] = { *dir, *dir < SNAKE_ACTION_LEFT ? SNAKE_ACTION_LEFT : SNAKE_ACTION_UP, 0 };
+    options[2] = options[1] + 1;
+    if (rngBelow(rng, 2)) {
+        options[1]++;
+        options[2]--;
+    }
+    int first = rngBelow(rng, 8) == 0;  // Sometimes turn even when straight on is safe
+    for (int k = first; k < first + 3; k++) {
+        int32_t a = options[k % 3];
+        int x = head % config->cols + dx[a];
+        int y = head / config->cols + dy[a];
+        if (x < 0 || x >= config->cols || y < 0 || y >= config->rows) continue;
+        uint8_t c = cells[y * config->cols + x];
+        if (c == SNAKE_OBS_BODY || c == SNAKE_OBS_DEATH) continue;
+        *dir = a;
+        return a;
+    }
+    return SNAKE_ACTION_KEEP;  // Trapped
+}
+
+// Index of the first float outside [0, 1], -1 if there is none
+static long floatOutOfRange(const uint8_t *obs, size_t size) {
+    const float *v = (const float *)obs;
+    for (size_t i = 0; i < size / sizeof(float); i++) {
+        if (!(v[i] >= 0.0f && v[i] <= 1.0f)) return (long)i;
+    }
+    return -1;
+}
+
+// First cell of a whole-board float observation whose body age is wrong,
+// -1 if there is none. On a body of n cells the ages must be k / n for
+// k = 1..n, each once, with n / n on the head; off the body they are 0.
+static long bodyAgeWrong(const uint8_t *obs, size_t cells) {
+    const float *v = (const float *)obs;
+    const float *head = v + SNAKE_PLANE_HEAD * cells;
+    const float *body = v + SNAKE_PLANE_BODY * cells;
+    const float *age = v + SNAKE_PLANE_BODY_AGE * cells;
+    int n = 0;
+    for (size_t i = 0; i < cells; i++) n += body[i] != 0.0f;
+
+    uint8_t *seen = calloc((size_t)n + 1, 1);
+    long wrong = -1;
+    for (size_t i = 0; seen && wrong < 0 && i < cells; i++) {
+        if (body[i] == 0.0f) {
+            if (age[i] != 0.0f) wrong = (long)i;
+            continue;
+        }
+        int k = (int)(age[i] * (float)n + 0.5f);
+        if (k < 1 || k > n || seen[k] || age[i] != (float)k / (float)n || (k == n) != (head[i] != 0.0f))
+            wrong = (long)i;
+        else
+            seen[k] = 1;
+    }
+    free(seen);
+    return wrong;
+}
+
+// Name of a test case for the report
+static void caseName(char *name, size_t size, const TestBoard *board, const SnakeObsSpec *spec) {
+    snprintf(name, size, "%s %s crop %d%s", board->name, layoutNames[spec->layout], spec->crop,
+             spec->inPlace ? " in place" : "");
+}
+
+// pilot plays the same game in SNAKE_LAYOUT_CELLS to steer by. Without
+// inPlace the buffer is scribbled over before every step, which must not
+// show in the observation.
+static int testEnv(const TestBoard *board, const SnakeObsSpec *spec) {
+    char name[64];
+    caseName(name, sizeof(name), board, spec);
+    SnakeEnv *env = snakeEnvCreate(&board->config);
+    SnakeEnv *pilot = snakeEnvCreate(&board->config);
+    if (!env || !pilot || !snakeEnvSetObservation(env, spec)) {
+        printf("FAIL %s: cannot create the environment\n", name);
+        snakeEnvDestroy(env);
+        snakeEnvDestroy(pilot);
+        return 0;
+    }
+    size_t size = snakeEnvObservationSize(env);
+    size_t cellCount = (size_t)board->config.cols * (size_t)board->config.rows;
+    int checkAge = spec->layout == SNAKE_LAYOUT_FLOAT && spec->crop == 0;
+    uint8_t *obs = malloc(size);
+    uint8_t *full = malloc(size);
+    uint8_t *cells = malloc(snakeEnvObservationSize(pilot));
+    Rng rng;
+    rngSeed(&rng, 1, 0);
+
+    int ok = obs && full && cells;
+    uint64_t episode = 0;
+    int32_t dir = SNAKE_ACTION_RIGHT;
+    int best = 0;
+    if (ok) {
+        snakeEnvReset(env, episode, obs);
+        snakeEnvReset(pilot, episode, cells);
+    }
+    for (long step = 0; ok && step < TEST_STEPS; step++) {
+        int32_t action = safeAction(cells, &board->config, &dir, &rng);
+        if (!spec->inPlace) memset(obs, 0xa5, size);
+        SnakeEnvStep r = snakeEnvStep(env, action, obs);
+        snakeEnvStep(pilot, action, cells);
+        snakeEnvObserve(env, full);
+        if (memcmp(obs, full, size) != 0) {
+            printf("FAIL %s: step %ld differs from a full write\n", name, step);
+            ok = 0;
+        }
+        long bad = spec->layout == SNAKE_LAYOUT_FLOAT ? floatOutOfRange(obs, size) : -1;
+        if (bad >= 0) {
+            printf("FAIL %s: step %ld value %ld is %f\n", name, step, bad, ((const float *)obs)[bad]);
+            ok = 0;
+        }
+        bad = checkAge ? bodyAgeWrong(obs, cellCount) : -1;
+        if (bad >= 0) {
+            printf("FAIL %s: step %ld cell %ld has the wrong body age\n", name, step, bad);
+            ok = 0;
+        }
+        if (r.done) {
+            if (r.score > best) best = r.score;
+            episode++;
+            dir = SNAKE_ACTION_RIGHT;
+            snakeEnvReset(env, episode, obs);
+            snakeEnvReset(pilot, episode, cells);
+        }
+    }
+    if (ok) printf("ok   %s: %d steps, %llu games, best score %d\n", name, TEST_STEPS,
+                   (unsigned long long)episode + 1, best);
+    free(obs);
+    free(full);
+    free(cells);
+    snakeEnvDestroy(env);
+    snakeEnvDestroy(pilot);
+    return ok;
+}
+
+static int testVecEnv(const TestBoard *board) {
+    SnakeVecEnv *venv = snakeVecEnvCreate(&board->config, VEC_GAMES);
+    SnakeObsSpec spec = { SNAKE_LAYOUT_FLOAT, 0, 1 };
+    if (!venv || !snakeVecEnvSetObservation(venv, &spec)) {
+        printf("FAIL %s vector float: cannot create the environment\n", board->name);
+        snakeVecEnvDestroy(venv);
+        return 0;
+    }
+    size_t size = snakeVecEnvObservationSize(venv);
+    uint8_t *obs = malloc(size * VEC_GAMES);
+    int32_t actions[VEC_GAMES], dones[VEC_GAMES];
+    float rewards[VEC_GAMES];
+    Rng rng;
+    rngSeed(&rng, 2, 0);
+
+    int ok = obs != NULL;
+    if (ok) snakeVecEnvReset(venv, 3, obs);
+    for (long step = 0; ok && step < VEC_STEPS; step++) {
+        for (int i = 0; i < VEC_GAMES; i++) actions[i] = randomAction(&rng);
+        snakeVecEnvStep(venv, actions, obs, rewards, dones, NULL);
+        long bad = floatOutOfRange(obs, size * VEC_GAMES);
+        if (bad >= 0) {
+            printf("FAIL %s vector float: step %ld value %ld is %f\n",
+                   board->name, step, bad, ((const float *)obs)[bad]);
+            ok = 0;
+        }
+    }
+    if (ok) printf("ok   %s vector float: %d games x %d steps\n", board->name, VEC_GAMES, VEC_STEPS);
+    free(obs);
+    snakeVecEnvDestroy(venv);
+    return ok;
+}
+
+// Seed of a batch slot's episode, as documented for snakeVecEnvReset()
+static uint64_t slotSeed(uint64_t seed, int slot, uint32_t episode) {
+    return mixSeed(mixSeed(seed + (uint64_t)slot * 0x9E3779B97F4A7C15ull) + episode);
+}
+
+// Step a batch of count games and, next to it, one single environment per
+// slot reset with the slot's seeds. Each slot draws its actions from its
+// own generator, so a slot plays the same games whatever the batch size.
+// Rewards, dones, scores and observations must match on every step.
+static int testVecReplay(const TestBoard *board, int32_t count, const SnakeObsSpec *spec) {
+    char name[64];
+    caseName(name, sizeof(name), board, spec);
+    SnakeVecEnv *venv = snakeVecEnvCreate(&board->config, count);
+    SnakeEnv **singles = calloc((size_t)count, sizeof(SnakeEnv *));
+    int ok = venv && singles && snakeVecEnvSetObservation(venv, spec);
+    for (int32_t i = 0; ok && i < count; i++) {
+        singles[i] = snakeEnvCreate(&board->config);
+        ok = singles[i] && snakeEnvSetObservation(singles[i], spec);
+    }
+    size_t size = ok ? snakeVecEnvObservationSize(venv) : 0;
+    uint8_t *obs = malloc(size * (size_t)count);
+    uint8_t *single = malloc(size * (size_t)count);
+    int32_t *actions = malloc((size_t)count * sizeof(int32_t));
+    int32_t *dones = malloc((size_t)count * sizeof(int32_t));
+    int32_t *scores = malloc((size_t)count * sizeof(int32_t));
+    float *rewards = malloc((size_t)count * sizeof(float));
+    uint32_t *episodes = calloc((size_t)count, sizeof(uint32_t));
+    Rng *rngs = malloc((size_t)count * sizeof(Rng));
+    if (!ok || !obs || !single || !actions || !dones || !scores || !rewards || !episodes || !rngs) {
+        printf("FAIL %s replay x%d: cannot create the environments\n", name, count);
+        ok = 0;
+    }
+
+    long games = count;
+    if (ok) {
+        snakeVecEnvReset(venv, REPLAY_SEED, obs);
+        for (int32_t i = 0; i < count; i++) {
+            rngSeed(&rngs[i], REPLAY_SEED, (uint64_t)i);
+            snakeEnvReset(singles[i], slotSeed(REPLAY_SEED, i, 0), single + (size_t)i * size);
+        }
+        ok = memcmp(obs, single, size * (size_t)count) == 0;
+        if (!ok) printf("FAIL %s replay x%d: first observations differ\n", name, count);
+    }
+    for (long step = 0; ok && step < REPLAY_STEPS; step++) {
+        for (int32_t i = 0; i < count; i++) actions[i] = randomAction(&rngs[i]);
+        snakeVecEnvStep(venv, actions, obs, rewards, dones, scores);
+        for (int32_t i = 0; ok && i < count; i++) {
+            uint8_t *expected = single + (size_t)i * size;
+            SnakeEnvStep r = snakeEnvStep(singles[i], actions[i], expected);
+            if (r.done) {
+                games++;
+                snakeEnvReset(singles[i], slotSeed(REPLAY_SEED, i, ++episodes[i]), expected);
+            }
+            if (r.reward != rewards[i] || r.done != dones[i] || r.score != scores[i] ||
+                memcmp(expected, obs + (size_t)i * size, size) != 0) {
+                printf("FAIL %s replay x%d: slot %d step %ld differs from a single game\n",
+                       name, count, i, step);
+                ok = 0;
+            }
+        }
+    }
+    if (ok) printf("ok   %s replay x%d: %d steps, %ld games\n", name, count, REPLAY_STEPS, games);
+    for (int32_t i = 0; singles && i < count; i++) snakeEnvDestroy(singles[i]);
+    free(singles);
+    free(obs);
+    free(single);
+    free(actions);
+    free(dones);
+    free(scores);
+    free(rewards);
+    free(episodes);
+    free(rngs);
+    snakeVecEnvDestroy(venv);
+    return ok;
+}
+
+int main(void) {
+    // A small board with many temp food slots fills up and keeps several
+    // temp foods alive at once
+    TestBoard boards[] = {
+        { "default", snakeEnvDefaultConfig() },
+        { "small", { 12, 10, 3, 8, 2 } },
+    };
+    // Whole board in place and written whole, and a crop
+    static const SnakeObsSpec views[] = { { 0, 0, 1 }, { 0, 0, 0 }, { 0, 11, 1 } };
+    // Batch sizes below, at and above a lane block, with and without a tail
+    static const int32_t batchSizes[] = { 1, 5, 8, 19 };
+    static const SnakeObsSpec replaySpecs[] = { { SNAKE_LAYOUT_FLOAT, 0, 1 }, { SNAKE_LAYOUT_BITS, 11, 0 } };
+
+    int failed = 0;
+    for (size_t b = 0; b < sizeof(boards) / sizeof(boards[0]); b++) {
+        for (int32_t layout = SNAKE_LAYOUT_CELLS; layout <= SNAKE_LAYOUT_FLOAT; layout++) {
+            for (size_t v = 0; v < sizeof(views) / sizeof(views[0]); v++) {
+                SnakeObsSpec spec = views[v];
+                spec.layout = layout;
+                if (!testEnv(&boards[b], &spec)) failed++;
+            }
+        }
+        if (!testVecEnv(&boards[b])) failed++;
+        for (size_t s = 0; s < sizeof(replaySpecs) / sizeof(replaySpecs[0]); s++) {
+            for (size_t n = 0; n < sizeof(batchSizes) / sizeof(batchSizes[0]); n++) {
+                if (!testVecReplay(&boards[b], batchSizes[n], &replaySpecs[s])) failed++;
+            }
+        }
+    }
+    if (failed) printf("%d failed\n", failed);
+    return failed ? 1 : 0;
+}
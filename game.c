@@ -0,0 +1,838 @@
+// Game rules: snake movement, item spawning and timers. All state lives in a
+// GameState so several games can run side by side in one process.
+#include "game.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define OCC_WORD_BITS 64
+#define FREE_NONE UINT32_MAX  // freeSlot[] value for cells that are not free
+#define CHANCE_SCALE 10000     // Spawn chances are out of 10000
+#define Q32_ONE UINT32_MAX     // Survival probability 1.0 in Q32 fixed point
+
+static void buildSpawnCurves(SpawnCurves *curves);
+static void scheduleEvent(GameState *gs, uint32_t handle, EventKind kind, uint64_t frame);
+static void scheduleInitialEvents(GameState *gs);
+static void scheduleSpecialSpawn(GameState *gs, uint64_t firstFrame);
+static void removeTempFood(GameState *gs, int slot);
+
+/* ------------------ STATE ALLOCATION ------------------*/
+GameConfig defaultGameConfig(void) {
+    GameConfig config = {
+        DEFAULT_ROWS, DEFAULT_COLS,
+        DEFAULT_MAX_FOOD, DEFAULT_MAX_TEMP_FOOD, DEFAULT_MAX_DEATH_ITEMS
+    };
+    return config;
+}
+
+int validateGameConfig(const GameConfig *config) {
+    return config->rows >= MIN_BOARD_DIM && config->rows <= MAX_BOARD_DIM &&
+           config->cols >= MIN_BOARD_DIM && config->cols <= MAX_BOARD_DIM &&
+           config->maxFood >= 1 && config->maxFood <= MAX_ITEM_SLOTS &&
+           config->maxTempFood >= 0 && config->maxTempFood <= MAX_ITEM_SLOTS &&
+           config->maxDeathItems >= 0 && config->maxDeathItems <= MAX_ITEM_SLOTS;
+}
+
+// Round a byte offset up so the next array starts on a 64-byte boundary
+static size_t alignBlock(size_t offset) {
+    return (offset + 63) & ~(size_t)63;
+}
+
+// Allocate the GameState together with every board-sized and item array for
+// the given config in one contiguous block, then start a fresh game.
+// Returns NULL on an invalid config or allocation failure.
+GameState *createGameState(const GameConfig *config, uint64_t seed) {
+    if (!validateGameConfig(config)) return NULL;
+
+    size_t cells = (size_t)config->rows * (size_t)config->cols;
+    int occWords = (config->cols + OCC_WORD_BITS - 1) / OCC_WORD_BITS;
+
+    size_t offBody = alignBlock(sizeof(GameState));
+    size_t offFreeCells = alignBlock(offBody + cells * sizeof(uint32_t));
+    size_t offFreeSlot = alignBlock(offFreeCells + cells * sizeof(uint32_t));
+    size_t offOccupancy = alignBlock(offFreeSlot + cells * sizeof(uint32_t));
+    size_t offCellItem = alignBlock(offOccupancy + (size_t)config->rows * occWords * sizeof(uint64_t));
+    size_t offCellMap = alignBlock(offCellItem + cells * sizeof(uint16_t));
+    size_t offFood = alignBlock(offCellMap + cells);
+    size_t offTempFood = alignBlock(offFood + (size_t)config->maxFood * sizeof(Point));
+    size_t offDeath = alignBlock(offTempFood + (size_t)config->maxTempFood * sizeof(TempFood));
+    size_t handles = (size_t)EVENT_KINDS + (size_t)config->maxTempFood;
+    size_t offEvents = alignBlock(offDeath + (size_t)config->maxDeathItems * sizeof(DeathItem));
+    size_t offEventPos = alignBlock(offEvents + handles * sizeof(Event));
+    size_t total = alignBlock(offEventPos + handles * sizeof(int32_t));
+
+    unsigned char *block = calloc(1, total);
+    if (!block) return NULL;
+
+    GameState *gs = (GameState *)block;
+    gs->config = *config;
+    gs->boardCells = (int)cells;
+    gs->occWords = occWords;
+    gs->snake.body = (uint32_t *)(block + offBody);
+    gs->freeCells = (uint32_t *)(block + offFreeCells);
+    gs->freeSlot = (uint32_t *)(block + offFreeSlot);
+    gs->occupancy = (uint64_t *)(block + offOccupancy);
+    gs->cellItem = (uint16_t *)(block + offCellItem);
+    gs->cellMap = block + offCellMap;
+    gs->food = (Point *)(block + offFood);
+    gs->tempFood = (TempFood *)(block + offTempFood);
+    gs->deathItems = (DeathItem *)(block + offDeath);
+    gs->events.heap = (Event *)(block + offEvents);
+    gs->events.pos = (int32_t *)(block + offEventPos);
+    gs->specialItem.symbol = '$';
+    buildSpawnCurves(&gs->curves);
+
+    seedGameState(gs, seed);
+    resetGameState(gs);
+    return gs;
+}
+
+void destroyGameState(GameState *gs) {
+    free(gs);
+}
+
+// Reseed the game's random state. Call resetGameState() afterwards to start
+// a game that depends only on this seed.
+void seedGameState(GameState *gs, uint64_t seed) {
+    rngSeed(&gs->rng, seed, 0);
+}
+
+/* ------------------ CELL HELPERS ------------------*/
+static inline int cellIndex(const GameState *gs, Point p) {
+    return p.y * gs->config.cols + p.x;
+}
+
+/* ------------------ OCCUPANCY BITMAP ------------------*/
+static inline uint64_t *occupancyWord(const GameState *gs, Point p) {
+    return &gs->occupancy[(size_t)p.y * gs->occWords + p.x / OCC_WORD_BITS];
+}
+
+static inline int cellOccupied(const GameState *gs, Point p) {
+    return (int)((*occupancyWord(gs, p) >> (p.x % OCC_WORD_BITS)) & 1u);
+}
+
+static inline void setOccupied(GameState *gs, Point p) {
+    *occupancyWord(gs, p) |= (uint64_t)1 << (p.x % OCC_WORD_BITS);
+}
+
+static inline void clearOccupied(GameState *gs, Point p) {
+    *occupancyWord(gs, p) &= ~((uint64_t)1 << (p.x % OCC_WORD_BITS));
+}
+
+/* ------------------ CELL MAP AND FREE CELL INDEX ------------------*/
+// Empty the cell map and mark every cell free
+static void resetBoardCells(GameState *gs) {
+    memset(gs->cellMap, CELL_EMPTY, (size_t)gs->boardCells);
+    memset(gs->cellItem, 0, (size_t)gs->boardCells * sizeof(uint16_t));
+    for (int i = 0; i < gs->boardCells; i++) {
+        gs->freeCells[i] = (uint32_t)i;
+        gs->freeSlot[i] = (uint32_t)i;
+    }
+    gs->freeCount = gs->boardCells;
+
+    // Every cell changed at once
+    gs->dirtyCount = 0;
+    gs->dirtyOverflow = 1;
+}
+
+// Remove a cell from the free set (no-op if it is already taken)
+static void takeCell(GameState *gs, int cell) {
+    uint32_t slot = gs->freeSlot[cell];
+    if (slot == FREE_NONE) return;
+    uint32_t last = gs->freeCells[--gs->freeCount];
+    gs->freeCells[slot] = last;
+    gs->freeSlot[last] = slot;
+    gs->freeSlot[cell] = FREE_NONE;
+}
+
+// Return a cell to the free set (no-op if it is already free)
+static void releaseCell(GameState *gs, int cell) {
+    if (gs->freeSlot[cell] != FREE_NONE) return;
+    gs->freeCells[gs->freeCount] = (uint32_t)cell;
+    gs->freeSlot[cell] = (uint32_t)gs->freeCount++;
+}
+
+// Set what occupies a cell and keep the free set in sync. item is the slot
+// of the item in its array and is ignored for empty and body cells.
+static void setCell(GameState *gs, Point p, CellType type, int item) {
+    int cell = cellIndex(gs, p);
+    gs->version++;
+    if (gs->dirtyCount < DIRTY_CELL_CAP)
+        gs->dirtyCells[gs->dirtyCount++] = (uint32_t)cell;
+    else
+        gs->dirtyOverflow = 1;
+    gs->cellMap[cell] = (unsigned char)type;
+    gs->cellItem[cell] = (uint16_t)item;
+    if (type == CELL_EMPTY)
+        releaseCell(gs, cell);
+    else
+        takeCell(gs, cell);
+}
+
+// Pick a uniformly random free cell. Returns 0 and flags the board as full
+// when there is nowhere left to spawn.
+static int pickFreeCell(GameState *gs, Point *out) {
+    if (gs->freeCount == 0) {
+        if (!gs->boardFull) gs->version++;
+        gs->boardFull = 1;
+        return 0;
+    }
+    *out = cellPoint(gs, gs->freeCells[gameRandBelow(gs, (uint32_t)gs->freeCount)]);
+    if (gs->boardFull) gs->version++;
+    gs->boardFull = 0;
+    return 1;
+}
+
+/* ------------------ EVENT QUEUE ------------------*/
+static inline uint64_t eventFrame(const Event *e) {
+    return e->key >> EVENT_KIND_BITS;
+}
+
+static inline void placeEvent(EventQueue *q, int i, Event e) {
+    q->heap[i] = e;
+    q->pos[e.handle] = i;
+}
+
+static void siftUp(EventQueue *q, int i) {
+    Event e = q->heap[i];
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (q->heap[parent].key <= e.key) break;
+        placeEvent(q, i, q->heap[parent]);
+        i = parent;
+    }
+    placeEvent(q, i, e);
+}
+
+static void siftDown(EventQueue *q, int i) {
+    Event e = q->heap[i];
+    for (;;) {
+        int child = 2 * i + 1;
+        if (child >= q->count) break;
+        if (child + 1 < q->count && q->heap[child + 1].key < q->heap[child].key) child++;
+        if (e.key <= q->heap[child].key) break;
+        placeEvent(q, i, q->heap[child]);
+        i = child;
+    }
+    placeEvent(q, i, e);
+}
+
+// Schedule the event for handle on the given frame, replacing any pending one
+static void scheduleEvent(GameState *gs, uint32_t handle, EventKind kind, uint64_t frame) {
+    EventQueue *q = &gs->events;
+    Event e = { frame << EVENT_KIND_BITS | (uint64_t)kind, handle };
+    int i = q->pos[handle];
+    if (i < 0) i = q->count++;
+    placeEvent(q, i, e);
+    siftUp(q, i);
+    siftDown(q, q->pos[handle]);
+}
+
+static void cancelEvent(GameState *gs, uint32_t handle) {
+    EventQueue *q = &gs->events;
+    int i = q->pos[handle];
+    if (i < 0) return;
+    q->pos[handle] = -1;
+    Event last = q->heap[--q->count];
+    if (i == q->count) return;
+    placeEvent(q, i, last);
+    siftUp(q, i);
+    siftDown(q, q->pos[last.handle]);
+}
+
+// Hand a pending event over to another (unused) handle
+static void renameEvent(GameState *gs, uint32_t from, uint32_t to) {
+    EventQueue *q = &gs->events;
+    int i = q->pos[from];
+    q->pos[from] = -1;
+    q->pos[to] = i;
+    if (i >= 0) q->heap[i].handle = to;
+}
+
+/* ------------------ SPAWN HAZARD CURVES ------------------*/
+// Spawn times are drawn by inverting the survival function of the per-frame
+// rolls: draw u, then find the first roll at which the chance of having
+// missed every roll so far drops below u. Probabilities are Q32 fixed point.
+static inline uint32_t mulQ32(uint32_t a, uint32_t b) {
+    return (uint32_t)(((uint64_t)a * b) >> 32);
+}
+
+// Chance of one roll missing, for a hit chance out of CHANCE_SCALE
+static uint32_t missChance(int chance) {
+    if (chance <= 0) return Q32_ONE;
+    if (chance >= CHANCE_SCALE) return 0;
+    return (uint32_t)(((uint64_t)(CHANCE_SCALE - chance) << 32) / CHANCE_SCALE);
+}
+
+// pow[j] = q^(2^j)
+static void buildPowers(uint32_t *pow, uint32_t q) {
+    pow[0] = q;
+    for (int j = 1; j < 32; j++)
+        pow[j] = mulQ32(pow[j - 1], pow[j - 1]);
+}
+
+static void buildSpawnCurves(SpawnCurves *curves) {
+    for (int step = 0; step < TEMP_RAMP_BLOCKS; step++) {
+        uint32_t q = missChance(TEMP_FOOD_BASE_CHANCE + step);
+        uint32_t s = Q32_ONE;
+        for (int i = 0; i < TEMP_FOOD_FRAMES_PER_CHANCE; i++)
+            s = mulQ32(s, q);
+        curves->tempRamp[step] = s;
+    }
+    buildPowers(curves->tempPow, missChance(TEMP_FOOD_MAX_CHANCE));
+    buildPowers(curves->specialPow, missChance(SPECIAL_MAX_CHANCE));
+}
+
+// Rolls up to and including the first hit at a flat chance, given the
+// survival s reached so far. Binary search over the number of misses.
+static uint64_t flatRollsUntilHit(const uint32_t *pow, uint32_t s, uint32_t u) {
+    uint64_t misses = 0;
+    for (int j = 31; j >= 0; j--) {
+        uint32_t t = mulQ32(s, pow[j]);
+        if (t >= u) {
+            s = t;
+            misses += (uint64_t)1 << j;
+        }
+    }
+    return misses + 1;
+}
+
+// Rolls up to and including the first temp food hit when the first roll is
+// made at refresh counter r
+static uint64_t tempRollsUntilHit(GameState *gs, uint64_t r) {
+    uint32_t u = rngNext(&gs->rng);
+    uint32_t s = Q32_ONE;
+    uint64_t rolls = 0;
+
+    // While the chance is still ramping up, skip whole steps of the ramp when
+    // they all miss and walk single rolls otherwise
+    while (r / TEMP_FOOD_FRAMES_PER_CHANCE < TEMP_RAMP_BLOCKS) {
+        int step = (int)(r / TEMP_FOOD_FRAMES_PER_CHANCE);
+        if (r % TEMP_FOOD_FRAMES_PER_CHANCE == 0) {
+            uint32_t t = mulQ32(s, gs->curves.tempRamp[step]);
+            if (t >= u) {
+                s = t;
+                r += TEMP_FOOD_FRAMES_PER_CHANCE;
+                rolls += TEMP_FOOD_FRAMES_PER_CHANCE;
+                continue;
+            }
+        }
+        s = mulQ32(s, missChance(TEMP_FOOD_BASE_CHANCE + step));
+        rolls++;
+        r++;
+        if (s < u) return rolls;
+    }
+    return rolls + flatRollsUntilHit(gs->curves.tempPow, s, u);
+}
+
+/* ------------------ GAME SETUP ------------------*/
+void initSnake(GameState *gs) {
+    Snake *snake = &gs->snake;
+    snake->length = 3;
+    snake->segments = snake->length;
+    snake->head = 0;
+    snake->direction = RIGHT;
+    gs->nextDirection = RIGHT;  // Initialize next direction
+    gs->turnCount = 0;
+    gs->appliedTurnStamp = 0;
+    int startX = gs->config.cols / 2;
+    int startY = gs->config.rows / 2;
+    memset(gs->occupancy, 0, (size_t)gs->config.rows * gs->occWords * sizeof(uint64_t));
+    resetBoardCells(gs);
+    gs->boardFull = 0;
+    for (int i = 0; i < snake->length; i++) {
+        Point p = { startX - i, startY };
+        snake->body[i] = (uint32_t)cellIndex(gs, p);
+        setOccupied(gs, p);
+        setCell(gs, p, CELL_BODY, 0);
+    }
+}
+
+void resetGameState(GameState *gs) {
+    // Reset all game state variables
+    gs->gameOver = 0;
+    gs->frame = 0;
+    gs->refreshFrame = 0;
+    gs->movementFrameCounter = 0;
+    gs->nextDirection = RIGHT;
+    gs->speedBoostEndsAt = 0;
+    gs->speedBoostActive = 0;
+    gs->foodCount = 0;
+    gs->tempFoodCount = 0;
+    gs->deathItemCount = 0;
+
+    // Deactivate special items
+    gs->specialItem.active = 0;
+
+    // Clear all death item slots
+    for (int i = 0; i < gs->config.maxDeathItems; ++i) {
+        gs->deathItems[i].active = 0;
+        gs->deathItems[i].pos.x = 0;
+        gs->deathItems[i].pos.y = 0;
+        gs->deathItems[i].symbol = 'X';
+    }
+
+    // Reset snake
+    initSnake(gs);
+
+    // Place initial food
+    placeFood(gs);
+
+    scheduleInitialEvents(gs);
+}
+
+// Returns 1 if food was placed, 0 if all food slots are in use or the board is full
+int placeFood(GameState *gs) {
+    if (gs->foodCount >= gs->config.maxFood) return 0;
+
+    // Spawn on a free cell (never on the snake or another item)
+    Point newPos;
+    if (!pickFreeCell(gs, &newPos)) return 0;
+
+    setCell(gs, newPos, CELL_FOOD, gs->foodCount);
+    gs->food[gs->foodCount] = newPos;
+    gs->foodCount++;
+    return 1;
+}
+
+// Returns 1 if temp food was placed, 0 if all slots are in use or the board is full
+int placeTempFood(GameState *gs) {
+    if (gs->tempFoodCount < gs->config.maxTempFood) {
+        // Random free position (avoiding snake body and other items)
+        Point newPos;
+        if (!pickFreeCell(gs, &newPos)) return 0;
+
+        TempFood *tf = &gs->tempFood[gs->tempFoodCount];
+        tf->pos = newPos;
+
+        // Random type (70% normal, 20% double, 10% triple)
+        int typeRoll = (int)gameRandBelow(gs, 100);
+        if (typeRoll < 70) {
+            tf->foodType = 0;
+            tf->symbol = 'T';
+            tf->expiresAt = gs->frame + TEMP_FOOD_LIFETIME;
+        } else if (typeRoll < 90) {
+            tf->foodType = 1;
+            tf->symbol = 'D';
+            tf->expiresAt = gs->frame + TEMP_FOOD_DOUBLE_LIFETIME;
+        } else {
+            tf->foodType = 2;
+            tf->symbol = 'X';
+            tf->expiresAt = gs->frame + TEMP_FOOD_TRIPLE_LIFETIME;
+        }
+
+        setCell(gs, newPos, CELL_TEMP_FOOD + tf->foodType, gs->tempFoodCount);
+        scheduleEvent(gs, TEMP_EXPIRE_HANDLE(gs->tempFoodCount), EVENT_TEMP_EXPIRE, tf->expiresAt);
+        gs->tempFoodCount++;
+        return 1;
+    }
+    return 0;
+}
+
+// Returns 1 if a death item was placed, 0 if all slots are in use or the board is full
+int placeDeathItem(GameState *gs) {
+    // Find a free slot
+    int slot = -1;
+    for (int i = 0; i < gs->config.maxDeathItems; ++i) {
+        if (!gs->deathItems[i].active) { slot = i; break; }
+    }
+
+    // Pick a free position: off the snake and clear of every other item
+    Point p;
+    if (slot == -1 || !pickFreeCell(gs, &p)) return 0;
+
+    setCell(gs, p, CELL_DEATH, slot);
+    gs->deathItems[slot].pos = p;
+    gs->deathItems[slot].symbol = 'X';
+    gs->deathItems[slot].active = 1;
+    gs->deathItemCount++;
+    return 1;
+}
+
+/* ------------------ COLLISION FUNCTIONS ------------------*/
+int checkCollision(const GameState *gs, Point next) {
+    if (next.x < 0 || next.x >= gs->config.cols || next.y < 0 || next.y >= gs->config.rows)
+        return 1;
+    // Check collision with body segments. The head can never be the next cell,
+    // so a single bit test covers the whole body.
+    return cellOccupied(gs, next);
+}
+
+// Check if a point overlaps with any part of the snake (including head)
+int checkSnakeOverlap(const GameState *gs, Point p) {
+    return cellOccupied(gs, p);
+}
+
+static int isReverse(int a, int b) {
+    return (a == UP && b == DOWN) || (a == DOWN && b == UP) ||
+           (a == LEFT && b == RIGHT) || (a == RIGHT && b == LEFT);
+}
+
+// Turn the snake by the oldest queued turn that is still legal from its
+// current direction
+static void takeQueuedTurn(GameState *gs) {
+    while (gs->turnCount > 0) {
+        TurnIntent t = gs->turns[gs->turnHead];
+        gs->turnHead = (gs->turnHead + 1) % TURN_QUEUE_CAP;
+        gs->turnCount--;
+        if (t.direction != gs->snake.direction && !isReverse(t.direction, gs->snake.direction)) {
+            gs->nextDirection = t.direction;
+            gs->appliedTurnStamp = t.stamp;
+            return;
+        }
+    }
+}
+
+// Move snake body: step the head back one slot in the ring and write the new
+// cell there. The old tail drops off implicitly unless the snake is still
+// growing, in which case the tail is held back by one more segment.
+static void layHead(GameState *gs, Point next) {
+    Snake *snake = &gs->snake;
+    int growing = snake->segments < snake->length && snake->segments < gs->boardCells;
+    if (!growing) {
+        Point tail = snakeSegment(gs, snake->segments - 1);
+        clearOccupied(gs, tail);
+        setCell(gs, tail, CELL_EMPTY, 0);
+    }
+    snake->head = (snake->head == 0) ? gs->boardCells - 1 : snake->head - 1;
+    snake->body[snake->head] = (uint32_t)cellIndex(gs, next);
+    setOccupied(gs, next);
+    setCell(gs, next, CELL_BODY, 0);
+    if (growing)
+        snake->segments++;
+}
+
+void moveSnake(GameState *gs) {
+    Snake *snake = &gs->snake;
+
+    // Apply the buffered direction at the start of movement
+    takeQueuedTurn(gs);
+    snake->direction = gs->nextDirection;
+
+    Point next = snakeSegment(gs, 0);
+    switch (snake->direction) {
+        case UP: next.y--; break;
+        case DOWN: next.y++; break;
+        case LEFT: next.x--; break;
+        case RIGHT: next.x++; break;
+    }
+    if (checkCollision(gs, next)) {
+        gs->gameOver = 1;
+        gs->version++;
+        return;
+    }
+
+    // Resolve what the head is about to enter with a single cell map read
+    int ateFood = 0;
+    int foodIndex = -1;
+    int ateTempFood = 0;
+    int tempFoodIndex = -1;
+    int ateSpecialItem = 0;
+    int cell = cellIndex(gs, next);
+
+    switch (gs->cellMap[cell]) {
+        case CELL_FOOD:
+            ateFood = 1;
+            foodIndex = gs->cellItem[cell];
+            break;
+        case CELL_TEMP_FOOD:
+        case CELL_TEMP_FOOD_DOUBLE:
+        case CELL_TEMP_FOOD_TRIPLE:
+            ateTempFood = 1;
+            tempFoodIndex = gs->cellItem[cell];
+            break;
+        case CELL_SPECIAL:
+            ateSpecialItem = 1;
+            gs->specialItem.active = 0; // Deactivate special item
+            break;
+        case CELL_DEATH:
+            // Death items end the game BEFORE moving
+            gs->gameOver = 1;
+            gs->version++;
+            return;
+        default:
+            break;
+    }
+
+/* ------------------ MOVE SNAKE BODY ------------------*/
+    layHead(gs, next);
+
+    /* ------------------ SCORE PLACEMENT AND LOGIC FUNCTIONS ------------------*/
+    if (ateFood) {
+        // Remove eaten food by moving the last food into its slot
+        gs->foodCount--;
+        if (foodIndex != gs->foodCount) {
+            gs->food[foodIndex] = gs->food[gs->foodCount];
+            gs->cellItem[cellIndex(gs, gs->food[foodIndex])] = (uint16_t)foodIndex;
+        }
+
+        // Double points during speed boost
+        int growthAmount = gs->speedBoostActive ? 2 : 1;
+        snake->length += growthAmount;
+        placeFood(gs);
+    }
+
+    if (ateTempFood) {
+        TempFood eatenFood = gs->tempFood[tempFoodIndex]; // Store before removing
+        removeTempFood(gs, tempFoodIndex);
+
+        // Different rewards based on type
+        switch (eatenFood.foodType) {
+            case 0: // Normal temp food
+                snake->length += 2;
+                placeFood(gs);
+                break;
+            case 1: // Double points
+                snake->length += 4;
+                placeFood(gs);
+                placeFood(gs);
+                break;
+            case 2: // Triple points
+                snake->length += 6;
+                placeFood(gs);
+                placeFood(gs);
+                placeFood(gs);
+                break;
+        }
+    }
+
+    if (ateSpecialItem) {
+        snake->length += 2; // Special item gives modest immediate bonus
+        // Add regular food as reward
+        placeFood(gs);
+
+        // Activate speed boost for 750 frames with double scoring. The
+        // boost counts this frame, so it ends 749 frames from now.
+        gs->speedBoostActive = 1;
+        gs->speedBoostEndsAt = gs->frame + SPEED_BOOST_DURATION - 1;
+        scheduleEvent(gs, EVENT_BOOST_END, EVENT_BOOST_END, gs->speedBoostEndsAt);
+
+        // The special item starts rolling to respawn on this frame
+        scheduleSpecialSpawn(gs, gs->frame);
+    }
+}
+
+// Buffer a new direction for the next move, refusing 180-degree turns
+void steerSnake(GameState *gs, Direction dir) {
+    switch (dir) {
+        case UP:    if (gs->snake.direction == DOWN) return; break;
+        case DOWN:  if (gs->snake.direction == UP) return; break;
+        case LEFT:  if (gs->snake.direction == RIGHT) return; break;
+        case RIGHT: if (gs->snake.direction == LEFT) return; break;
+    }
+    gs->nextDirection = dir;
+}
+
+// Queue a turn for a later move, so quick key sequences such as up then
+// left within one move both take effect, one per move. Repeats of the last
+// queued direction and reversals of it are dropped, as is anything once
+// the queue is full. Returns 1 when the turn was queued.
+int queueTurn(GameState *gs, Direction dir, uint64_t stamp) {
+    int last = gs->turnCount > 0
+        ? gs->turns[(gs->turnHead + gs->turnCount - 1) % TURN_QUEUE_CAP].direction
+        : gs->nextDirection;
+    if ((int)dir == last || isReverse((int)dir, last) || gs->turnCount == TURN_QUEUE_CAP) return 0;
+
+    TurnIntent *t = &gs->turns[(gs->turnHead + gs->turnCount) % TURN_QUEUE_CAP];
+    t->direction = (int)dir;
+    t->stamp = stamp;
+    gs->turnCount++;
+    return 1;
+}
+
+
+/* ------------------ TIMERS AND SPAWNING ------------------*/
+// Hit chances out of CHANCE_SCALE for a roll at refresh counter rc.
+// Integer maths keeps the same seed bit-identical on every platform.
+static int specialChance(uint64_t rc) {
+    if (rc >= (uint64_t)SPECIAL_MAX_CHANCE) return SPECIAL_MAX_CHANCE;
+    uint64_t chance = SPECIAL_BASE_CHANCE + rc * SPECIAL_CHANCE_PER_FRAME;
+    return chance > SPECIAL_MAX_CHANCE ? SPECIAL_MAX_CHANCE : (int)chance;
+}
+
+// Temp food rolls once per frame while a slot is free
+static void scheduleTempSpawn(GameState *gs, uint64_t firstFrame) {
+    if (gs->tempFoodCount >= gs->config.maxTempFood) {
+        cancelEvent(gs, EVENT_TEMP_SPAWN);
+        return;
+    }
+    uint64_t rolls = tempRollsUntilHit(gs, firstFrame - gs->refreshFrame);
+    scheduleEvent(gs, EVENT_TEMP_SPAWN, EVENT_TEMP_SPAWN, firstFrame + rolls - 1);
+}
+
+// The special item rolls once per frame while it is off the board. Hits are
+// drawn at its maximum chance and thinned to the actual chance when the event
+// runs, see spawnSpecialItem().
+static void scheduleSpecialSpawn(GameState *gs, uint64_t firstFrame) {
+    uint32_t u = rngNext(&gs->rng);
+    uint64_t rolls = flatRollsUntilHit(gs->curves.specialPow, Q32_ONE, u);
+    scheduleEvent(gs, EVENT_SPECIAL_SPAWN, EVENT_SPECIAL_SPAWN, firstFrame + rolls - 1);
+}
+
+// Death items spawn when the refresh counter is a multiple of 20 and has
+// reached 250 frames for every death item already on the board
+static void scheduleDeathSpawn(GameState *gs, uint64_t firstFrame) {
+    if (gs->deathItemCount >= gs->config.maxDeathItems) {
+        cancelEvent(gs, EVENT_DEATH_SPAWN);
+        return;
+    }
+    uint64_t rc = firstFrame - gs->refreshFrame;
+    uint64_t earliest = (uint64_t)gs->deathItemCount * DEATH_FRAMES_PER_ITEM;
+    if (rc < earliest) rc = earliest;
+    rc = (rc + DEATH_SPAWN_PERIOD - 1) / DEATH_SPAWN_PERIOD * DEATH_SPAWN_PERIOD;
+    scheduleEvent(gs, EVENT_DEATH_SPAWN, EVENT_DEATH_SPAWN, gs->refreshFrame + rc);
+}
+
+static void scheduleInitialEvents(GameState *gs) {
+    EventQueue *q = &gs->events;
+    q->count = 0;
+    memset(q->pos, 0xFF, ((size_t)EVENT_KINDS + (size_t)gs->config.maxTempFood) * sizeof(int32_t));
+
+    // The first frame is frame 1, with the refresh counter at 1
+    scheduleTempSpawn(gs, 1);
+    scheduleSpecialSpawn(gs, 1);
+    scheduleDeathSpawn(gs, 1);
+}
+
+// Remove tempFood[slot] by moving the last temp food into its slot. The
+// caller has already cleared or reused its cell.
+static void removeTempFood(GameState *gs, int slot) {
+    int wasFull = gs->tempFoodCount >= gs->config.maxTempFood;
+
+    cancelEvent(gs, TEMP_EXPIRE_HANDLE(slot));
+    gs->tempFoodCount--;
+    if (slot != gs->tempFoodCount) {
+        gs->tempFood[slot] = gs->tempFood[gs->tempFoodCount];
+        gs->cellItem[cellIndex(gs, gs->tempFood[slot].pos)] = (uint16_t)slot;
+        renameEvent(gs, TEMP_EXPIRE_HANDLE(gs->tempFoodCount), TEMP_EXPIRE_HANDLE(slot));
+    }
+
+    // A slot opened up, so temp food rolls again from this frame on
+    if (wasFull) scheduleTempSpawn(gs, gs->frame);
+}
+
+static void expireTempFood(GameState *gs, int slot) {
+    setCell(gs, gs->tempFood[slot].pos, CELL_EMPTY, 0);
+    removeTempFood(gs, slot);
+}
+
+static void spawnTempFood(GameState *gs) {
+    placeTempFood(gs);
+    // Reset refresh counter after spawning to reset probability
+    gs->refreshFrame = gs->frame;
+    scheduleTempSpawn(gs, gs->frame + 1);
+    // Death spawns follow the refresh counter; this frame's check is still to come
+    scheduleDeathSpawn(gs, gs->frame);
+}
+
+static void spawnSpecialItem(GameState *gs) {
+    // The hit was drawn at the maximum chance. Keep it with probability
+    // chance / max, which only matters on the frame temp food spawned.
+    int chance = specialChance(refreshCounter(gs));
+    if (chance < SPECIAL_MAX_CHANCE && (int)gameRandBelow(gs, SPECIAL_MAX_CHANCE) >= chance) {
+        scheduleSpecialSpawn(gs, gs->frame + 1);
+        return;
+    }
+
+    // Spawn special item at a random free location (avoid snake body and items)
+    gs->specialItem.symbol = '$'; // Default symbol
+    if (pickFreeCell(gs, &gs->specialItem.pos)) {
+        setCell(gs, gs->specialItem.pos, CELL_SPECIAL, 0);
+        gs->specialItem.active = 1;
+    } else {
+        scheduleSpecialSpawn(gs, gs->frame + 1); // Board full, keep rolling
+    }
+}
+
+static void spawnDeathItem(GameState *gs) {
+    placeDeathItem(gs);
+    scheduleDeathSpawn(gs, gs->frame + 1);
+}
+
+static void runEvent(GameState *gs, Event e) {
+    switch ((EventKind)(e.key & ((1u << EVENT_KIND_BITS) - 1))) {
+        case EVENT_TEMP_EXPIRE:
+            expireTempFood(gs, (int)(e.handle - TEMP_EXPIRE_HANDLE(0)));
+            break;
+        case EVENT_BOOST_END:
+            gs->speedBoostActive = 0;
+            gs->version++;
+            break;
+        case EVENT_TEMP_SPAWN:
+            spawnTempFood(gs);
+            break;
+        case EVENT_SPECIAL_SPAWN:
+            spawnSpecialItem(gs);
+            break;
+        case EVENT_DEATH_SPAWN:
+            spawnDeathItem(gs);
+            break;
+        default:
+            break;
+    }
+}
+
+// First half of advanceFrame(): count the frame and move the snake if due
+void advanceMovement(GameState *gs) {
+    // Increment frame counters
+    gs->frame++;
+    gs->movementFrameCounter++;
+
+    // Only move snake at intervals (shorter under speed boost)
+    if (gs->movementFrameCounter >= currentMoveInterval(gs)) {
+        moveSnake(gs);
+        gs->movementFrameCounter = 0;
+    }
+}
+
+// Second half of advanceFrame(): timers and spawns due on this frame
+void runDueEvents(GameState *gs) {
+    // Frames with nothing due stop at this one comparison. Events due on the
+    // same frame run in EventKind order, including ones scheduled meanwhile.
+    EventQueue *q = &gs->events;
+    while (q->count > 0 && eventFrame(&q->heap[0]) <= gs->frame) {
+        Event e = q->heap[0];
+        cancelEvent(gs, e.handle);
+        runEvent(gs, e);
+    }
+}
+
+// Run one frame of game logic: movement at the current interval, then any
+// timers and spawns that fall due. Rendering and input are left to the caller.
+void advanceFrame(GameState *gs) {
+    advanceMovement(gs);
+    runDueEvents(gs);
+}
+
+// Frames before the next move only bump counters unless an event falls due,
+// so jump straight to whichever comes first: the move or the next event.
+// Events can end the speed boost, which changes the interval, so it is read
+// again after each one.
+void advanceToNextMove(GameState *gs) {
+    EventQueue *q = &gs->events;
+    while (!gs->gameOver) {
+        int idle = currentMoveInterval(gs) - gs->movementFrameCounter - 1;
+        if (idle < 0) idle = 0;
+        uint64_t moveFrame = gs->frame + (uint64_t)idle + 1;
+        if (q->count > 0 && eventFrame(&q->heap[0]) < moveFrame) {
+            uint64_t skip = eventFrame(&q->heap[0]) - gs->frame;
+            gs->frame += skip;
+            gs->movementFrameCounter += (int)skip;
+            runDueEvents(gs);
+            continue;
+        }
+        gs->frame += (uint64_t)idle;
+        gs->movementFrameCounter += idle;
+        advanceFrame(gs);
+        return;
+    }
+}
+
+int advanceOntoEmptyCell(GameState *gs, int direction, Point next, uint64_t moveFrame) {
+    if (gs->gameOver || gs->turnCount > 0 || cellAt(gs, next) != CELL_EMPTY) return 0;
+    gs->frame = moveFrame;
+    gs->movementFrameCounter = 0;
+    gs->nextDirection = direction;
+    gs->snake.direction = direction;
+    layHead(gs, next);
+    return 1;
+}
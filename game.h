@@ -0,0 +1,303 @@
+#ifndef GAME_H
+#define GAME_H
+
+// Game rules and state. Nothing in here touches curses, so any number of
+// games can be created and stepped independently from one process.
+
+#include <stddef.h>
+#include <stdint.h>
+#include "rng.h"
+
+#define DEFAULT_ROWS 20
+#define DEFAULT_COLS 40
+#define DEFAULT_MAX_FOOD 5
+#define DEFAULT_MAX_TEMP_FOOD 3
+#define DEFAULT_MAX_DEATH_ITEMS 4
+#define MIN_BOARD_DIM 4
+#define MAX_BOARD_DIM 4096
+#define MAX_ITEM_SLOTS 65535  // Item slots must fit the 16-bit cellItem[] index
+#define TEMP_FOOD_LIFETIME 800         // Frames before temp food ('T', worth 1) disappears
+#define TEMP_FOOD_DOUBLE_LIFETIME 600  // Double points temp food ('D')
+#define TEMP_FOOD_TRIPLE_LIFETIME 400  // Triple points temp food ('X')
+#define MOVEMENT_FRAME_INTERVAL 10  // Snake moves every N frames
+#define SPEED_BOOST_DURATION 750    // Frames of speed boost after eating a special item
+#define DIRTY_CELL_CAP 256  // Cell changes listed between redraws before asking for a full one
+#define TURN_QUEUE_CAP 4    // Queued turns at most, later key presses are dropped until a move
+
+// Per-frame spawn chances, in units of 1/10000 so every platform agrees
+#define SPECIAL_BASE_CHANCE 1           // 0.01% on the frame after a refresh reset
+#define SPECIAL_CHANCE_PER_FRAME 100    // How fast the chance increases
+#define SPECIAL_MAX_CHANCE 50           // 0.5% maximum
+#define TEMP_FOOD_BASE_CHANCE 10        // 0.1% base chance
+#define TEMP_FOOD_FRAMES_PER_CHANCE 10  // +0.01% every 10 frames
+#define TEMP_FOOD_MAX_CHANCE 200        // 2% maximum
+#define TEMP_RAMP_BLOCKS (TEMP_FOOD_MAX_CHANCE - TEMP_FOOD_BASE_CHANCE)  // Steps before the cap
+#define DEATH_FRAMES_PER_ITEM 250       // One more death item allowed every 250 frames
+#define DEATH_SPAWN_PERIOD 20           // Death items spawn on multiples of 20 frames
+
+// Directions
+typedef enum {
+    UP,
+    DOWN,
+    LEFT,
+    RIGHT
+} Direction;
+
+// A turn the player asked for, waiting for the next snake move
+typedef struct {
+    int direction;
+    uint64_t stamp;  // Caller's timestamp of the key press, handed back when applied
+} TurnIntent;
+
+typedef struct {
+    int x;
+    int y;
+} Point;
+
+// What occupies a board cell. Temp food types are consecutive so that
+// CELL_TEMP_FOOD + foodType gives the cell type for each variant.
+typedef enum {
+    CELL_EMPTY = 0,
+    CELL_BODY,
+    CELL_FOOD,
+    CELL_TEMP_FOOD,         // foodType 0
+    CELL_TEMP_FOOD_DOUBLE,  // foodType 1
+    CELL_TEMP_FOOD_TRIPLE,  // foodType 2
+    CELL_SPECIAL,
+    CELL_DEATH
+} CellType;
+
+typedef struct {
+    Point pos;
+    uint64_t expiresAt;  // Frame on which the food disappears
+    //int blinkCounter;
+    int foodType;    // 0=normal, 1=double points, 2=triple points
+    char symbol;     // Different symbols for different types
+} TempFood;
+
+// Board size and item caps, fixed for the lifetime of a GameState
+typedef struct {
+    int rows;
+    int cols;
+    int maxFood;
+    int maxTempFood;
+    int maxDeathItems;
+} GameConfig;
+
+typedef struct {
+    uint32_t *body;  // Ring buffer of cell indices, the head lives at body[head]
+    int head;        // Index of the head segment in body[]
+    int segments;    // Segments currently laid out on the board
+    int length;      // Target length, segments catch up by holding the tail back
+    int direction;
+} Snake;
+
+typedef struct {
+    Point pos;
+    int active;
+    char symbol;
+} SpecialItem;
+
+typedef struct {
+    Point pos;
+    int active;
+    char symbol;
+} DeathItem;
+
+// Timed events, in the order they run when several fall on the same frame
+typedef enum {
+    EVENT_TEMP_EXPIRE,    // A temp food times out
+    EVENT_BOOST_END,      // The speed boost wears off
+    EVENT_TEMP_SPAWN,     // Next temp food spawn
+    EVENT_SPECIAL_SPAWN,  // Next special item roll that succeeds
+    EVENT_DEATH_SPAWN,    // Next death item spawn attempt
+    EVENT_KINDS
+} EventKind;
+
+#define EVENT_KIND_BITS 3
+// Handle of the expiry event for tempFood[slot]. Other kinds use their own
+// EventKind value as the handle, so each has at most one pending event.
+#define TEMP_EXPIRE_HANDLE(slot) ((uint32_t)EVENT_KINDS + (uint32_t)(slot))
+
+typedef struct {
+    uint64_t key;     // frame << EVENT_KIND_BITS | kind, the heap order
+    uint32_t handle;
+} Event;
+
+// Binary min-heap of pending events. pos[] maps each handle to its heap
+// slot so events can be moved or cancelled without leaving stale entries.
+typedef struct {
+    Event *heap;
+    int32_t *pos;  // -1 when the handle has no pending event
+    int count;
+} EventQueue;
+
+// Fixed-point (Q32) per-roll survival tables for the spawn hazard curves,
+// built once per GameState. pow[j] tables hold q^(2^j) for a flat chance.
+typedef struct {
+    uint32_t tempRamp[TEMP_RAMP_BLOCKS];  // Survival over each ramp step
+    uint32_t tempPow[32];                 // Temp food past the ramp
+    uint32_t specialPow[32];              // Special item at its maximum chance
+} SpawnCurves;
+
+// Everything one game needs. Created by createGameState() together with all
+// of its board-sized arrays in a single allocation.
+typedef struct {
+    GameConfig config;
+    int boardCells;  // config.rows * config.cols, also the snake ring capacity
+    int occWords;    // Occupancy bitmap words per board row
+
+    Snake snake;
+    uint64_t *occupancy;     // One bit per board cell covered by the snake, occWords per row
+    unsigned char *cellMap;  // CellType of every board cell
+    uint16_t *cellItem;      // Slot in food[]/tempFood[]/deathItems[] for item cells
+    uint32_t *freeCells;     // Dense set of cells holding neither snake nor item
+    uint32_t *freeSlot;      // Position of each cell in freeCells[], FREE_NONE when not free
+    int freeCount;
+    int boardFull;  // Set when a spawn found no free cell left on the board
+
+    // Cells whose CellType changed since the last clearDirtyCells(), for
+    // renderers and observation encoders that only redo what changed.
+    // Duplicates are possible.
+    uint32_t dirtyCells[DIRTY_CELL_CAP];
+    int dirtyCount;
+    int dirtyOverflow;  // Too many changes to list, or a reset: redraw every cell
+
+    Point *food;
+    int foodCount;
+    TempFood *tempFood;
+    int tempFoodCount;
+    SpecialItem specialItem;
+    DeathItem *deathItems;
+
+    int deathItemCount;  // Active death items, they stay until the game ends
+
+    // Bumped on every change a player could see: cells, the head, score,
+    // boost on/off, board full, game over. Renderers skip frames where it
+    // did not move. Never reset, so a reset also counts as a change.
+    uint64_t version;
+
+    int gameOver;
+    uint64_t frame;            // Frames since the game started
+    uint64_t refreshFrame;     // Frame of the last temp food roll that hit, see refreshCounter()
+    int movementFrameCounter;  // Counter for movement timing
+    int nextDirection;         // Buffer for next direction to prevent double-turns
+    TurnIntent turns[TURN_QUEUE_CAP];  // Ring of queued turns, one is applied per move
+    int turnHead;
+    int turnCount;
+    uint64_t appliedTurnStamp; // Stamp of the last turn a move applied, 0 if none. Readers clear it.
+    uint64_t speedBoostEndsAt; // Frame on which the speed boost wears off
+    int speedBoostActive;      // Flag for whether speed boost is active
+
+    EventQueue events;  // Spawns, expiries and timers, so idle frames cost nothing
+    SpawnCurves curves;
+
+    Rng rng;  // Per-game random state, never shared between games
+} GameState;
+
+// Lifecycle
+GameConfig defaultGameConfig(void);
+int validateGameConfig(const GameConfig *config);
+GameState *createGameState(const GameConfig *config, uint64_t seed);
+void destroyGameState(GameState *gs);
+void resetGameState(GameState *gs);
+void seedGameState(GameState *gs, uint64_t seed);
+
+// Rules
+void initSnake(GameState *gs);
+int checkCollision(const GameState *gs, Point next);
+int checkSnakeOverlap(const GameState *gs, Point p);
+int placeFood(GameState *gs);
+int placeTempFood(GameState *gs);
+int placeDeathItem(GameState *gs);
+void moveSnake(GameState *gs);
+void steerSnake(GameState *gs, Direction dir);
+int queueTurn(GameState *gs, Direction dir, uint64_t stamp);
+void advanceFrame(GameState *gs);
+// advanceFrame() in its two steps, for callers that time them separately
+void advanceMovement(GameState *gs);
+void runDueEvents(GameState *gs);
+// Run frames up to and including the next snake move, or until the game
+// ends. Same result as advanceFrame() in a loop, without the idle frames.
+void advanceToNextMove(GameState *gs);
+// advanceToNextMove() when only the move happens: the snake turns to
+// direction and its head enters next on moveFrame. The caller has checked
+// that next is on the board and that no event falls due up to and including
+// moveFrame (see nextEventFrame()). Returns 0 and changes nothing when that
+// is not all, because a turn is queued, the game is over or next holds the
+// body or an item; advanceToNextMove() then does the step.
+int advanceOntoEmptyCell(GameState *gs, int direction, Point next, uint64_t moveFrame);
+
+// Per-game random number in [0, bound), bound must be non-zero
+static inline uint32_t gameRandBelow(GameState *gs, uint32_t bound) {
+    return rngBelow(&gs->rng, bound);
+}
+
+static inline Point cellPoint(const GameState *gs, uint32_t cell) {
+    Point p = { (int)(cell % (uint32_t)gs->config.cols), (int)(cell / (uint32_t)gs->config.cols) };
+    return p;
+}
+
+// Segment i counted from the head (0 = head, snake.segments - 1 = tail)
+static inline Point snakeSegment(const GameState *gs, int i) {
+    int idx = gs->snake.head + i;
+    if (idx >= gs->boardCells) idx -= gs->boardCells;
+    return cellPoint(gs, gs->snake.body[idx]);
+}
+
+// Call after a renderer or encoder has caught up with the board
+static inline void clearDirtyCells(GameState *gs) {
+    gs->dirtyCount = 0;
+    gs->dirtyOverflow = 0;
+}
+
+// Cell index of the snake's head
+static inline uint32_t snakeHeadCell(const GameState *gs) {
+    return gs->snake.body[gs->snake.head];
+}
+
+// Frame of the earliest pending event, UINT64_MAX when none is
+static inline uint64_t nextEventFrame(const GameState *gs) {
+    return gs->events.count > 0 ? gs->events.heap[0].key >> EVENT_KIND_BITS : UINT64_MAX;
+}
+
+// Frames since temp food last spawned; spawn chances ramp up with it
+static inline uint64_t refreshCounter(const GameState *gs) {
+    return gs->frame - gs->refreshFrame;
+}
+
+static inline int tempFoodTimeLeft(const GameState *gs, const TempFood *tf) {
+    return (int)(tf->expiresAt - gs->frame);
+}
+
+// Frames a temp food of this foodType lasts from when it spawns
+static inline int tempFoodLifetime(int foodType) {
+    return foodType == 0 ? TEMP_FOOD_LIFETIME
+         : foodType == 1 ? TEMP_FOOD_DOUBLE_LIFETIME
+         : TEMP_FOOD_TRIPLE_LIFETIME;
+}
+
+static inline int speedBoostFramesLeft(const GameState *gs) {
+    return gs->speedBoostActive ? (int)(gs->speedBoostEndsAt - gs->frame) : 0;
+}
+
+static inline int gameScore(const GameState *gs) {
+    return gs->snake.length - 3;
+}
+
+static inline CellType cellAt(const GameState *gs, Point p) {
+    return (CellType)gs->cellMap[p.y * gs->config.cols + p.x];
+}
+
+// Frames between snake moves, shorter while the speed boost is active
+static inline int currentMoveInterval(const GameState *gs) {
+    return gs->speedBoostActive ? MOVEMENT_FRAME_INTERVAL * 2 / 3  // 33% faster movement
+                                : MOVEMENT_FRAME_INTERVAL;
+}
+
+// Non-zero when the next advanceFrame() call will move the snake
+static inline int moveDueNextFrame(const GameState *gs) {
+    return gs->movementFrameCounter + 1 >= currentMoveInterval(gs);
+}
+
+#endif // GAME_H
@@ -0,0 +1,196 @@
+// Headless simulation runner. Plays whole games through advanceFrame() with a
+// scripted or random input source and reports engine throughput.
+#include "headless.h"
+#include "timing.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define AUTOPILOT_STREAM 1  // Rng stream for the autopilot, the game itself uses 0
+
+HeadlessOptions defaultHeadlessOptions(void) {
+    HeadlessOptions opts = { DEFAULT_HEADLESS_GAMES, DEFAULT_HEADLESS_MAX_FRAMES, NULL, 0, 1 };
+    return opts;
+}
+
+/* ------------------ INPUT SOURCES ------------------*/
+uint64_t headlessGameSeed(uint64_t baseSeed, uint32_t index) {
+    return mixSeed(baseSeed + (uint64_t)index * 0x9E3779B97F4A7C15ull);
+}
+
+int loadInputScript(InputSource *in, const char *path) {
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        fprintf(stderr, "Cannot open input script %s\n", path);
+        return 0;
+    }
+    fseek(f, 0, SEEK_END);
+    in->length = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    in->keys = malloc(in->length > 0 ? (size_t)in->length : 1);
+    if (!in->keys || fread(in->keys, 1, (size_t)in->length, f) != (size_t)in->length) {
+        fprintf(stderr, "Cannot read input script %s\n", path);
+        fclose(f);
+        free(in->keys);
+        in->keys = NULL;
+        return 0;
+    }
+    fclose(f);
+    if (in->length == 0) {
+        fprintf(stderr, "Input script %s is empty\n", path);
+        free(in->keys);
+        in->keys = NULL;
+        return 0;
+    }
+    return 1;
+}
+
+static Point stepPoint(Point p, Direction dir) {
+    switch (dir) {
+        case UP: p.y--; break;
+        case DOWN: p.y++; break;
+        case LEFT: p.x--; break;
+        case RIGHT: p.x++; break;
+    }
+    return p;
+}
+
+// A move is safe when it stays on the board, off the snake and off death items
+static int safeMove(const GameState *gs, Direction dir) {
+    Point next = stepPoint(snakeSegment(gs, 0), dir);
+    return !checkCollision(gs, next) && cellAt(gs, next) != CELL_DEATH;
+}
+
+// Random autopilot: mostly keeps going straight, turns now and then, and
+// avoids moves that would end the game when it has a choice.
+static void autopilotSteer(GameState *gs, InputSource *in) {
+    Direction current = (Direction)gs->snake.direction;
+    Direction turns[2];
+    if (current == UP || current == DOWN) {
+        turns[0] = LEFT;
+        turns[1] = RIGHT;
+    } else {
+        turns[0] = UP;
+        turns[1] = DOWN;
+    }
+
+    Direction options[3];
+    int count = 0;
+    int straightSafe = safeMove(gs, current);
+    for (int i = 0; i < 2; i++) {
+        if (safeMove(gs, turns[i])) options[count++] = turns[i];
+    }
+
+    // Turn about one move in ten, or whenever going straight is fatal
+    if (count > 0 && (!straightSafe || rngBelow(&in->rng, 10) == 0)) {
+        steerSnake(gs, options[rngBelow(&in->rng, (uint32_t)count)]);
+    } else {
+        steerSnake(gs, current);
+    }
+}
+
+// Feed the next scripted key. W/A/S/D steer, anything else keeps the
+// current direction for that move.
+static void scriptSteer(GameState *gs, InputSource *in) {
+    char key = in->keys[in->position];
+    if (++in->position >= in->length) in->position = 0;
+    switch (key) {
+        case 'W': case 'w': steerSnake(gs, UP); break;
+        case 'S': case 's': steerSnake(gs, DOWN); break;
+        case 'A': case 'a': steerSnake(gs, LEFT); break;
+        case 'D': case 'd': steerSnake(gs, RIGHT); break;
+    }
+}
+
+void restartInput(InputSource *in, uint64_t seed) {
+    in->position = 0;
+    rngSeed(&in->rng, seed, AUTOPILOT_STREAM);
+}
+
+void steerFromInput(GameState *gs, InputSource *in) {
+    if (in->keys)
+        scriptSteer(gs, in);
+    else
+        autopilotSteer(gs, in);
+}
+
+/* ------------------ RUNNER ------------------*/
+// Play one game from a fresh reset. The script restarts from its first key
+// and the autopilot is reseeded, so every game depends only on its seed.
+static GameResult playGame(GameState *gs, uint64_t seed, int maxFrames, InputSource *in) {
+    GameResult result = { 0, 0, 0, 0, 0 };
+
+    seedGameState(gs, seed);
+    resetGameState(gs);
+    restartInput(in, seed);
+
+    while (!gs->gameOver && result.frames < maxFrames) {
+        if (moveDueNextFrame(gs)) {
+            steerFromInput(gs, in);
+            result.moves++;
+        }
+        advanceFrame(gs);
+        result.frames++;
+    }
+
+    result.score = gameScore(gs);
+    result.length = gs->snake.length;
+    result.capped = !gs->gameOver;
+    return result;
+}
+
+GameResult playAutopilotGame(GameState *gs, uint64_t seed, int maxFrames) {
+    InputSource in = { NULL, 0, 0, { 0, 0 } };
+    return playGame(gs, seed, maxFrames, &in);
+}
+
+int runHeadless(const GameConfig *config, const HeadlessOptions *opts) {
+    InputSource in = { NULL, 0, 0, { 0, 0 } };
+    if (opts->scriptPath && !loadInputScript(&in, opts->scriptPath)) return 1;
+
+    GameState *gs = createGameState(config, opts->seed);
+    if (!gs) {
+        fprintf(stderr, "Cannot create a %dx%d game\n", config->cols, config->rows);
+        free(in.keys);
+        return 1;
+    }
+
+    unsigned long long totalFrames = 0;
+    unsigned long long totalMoves = 0;
+    long long scoreSum = 0;
+    int minScore = 0;
+    int maxScore = 0;
+    int capped = 0;
+
+    uint64_t start = monotonicNs();
+    for (int g = 0; g < opts->games; g++) {
+        GameResult r = playGame(gs, headlessGameSeed(opts->seed, (uint32_t)g), opts->maxFrames, &in);
+
+        int score = r.score;
+        if (r.capped) capped++;
+        if (g == 0 || score < minScore) minScore = score;
+        if (g == 0 || score > maxScore) maxScore = score;
+        scoreSum += score;
+        totalFrames += (unsigned long long)r.frames;
+        totalMoves += (unsigned long long)r.moves;
+
+        if (!opts->quiet) {
+            printf("game %d: score %d, length %d, frames %ld, moves %ld%s\n",
+                   g + 1, score, r.length, r.frames, r.moves,
+                   r.capped ? " (frame cap)" : "");
+        }
+    }
+    uint64_t elapsed = monotonicNs() - start;
+    double seconds = elapsed > 0 ? (double)elapsed / 1e9 : 1e-9;
+
+    printf("games: %d (%d hit the frame cap)\n", opts->games, capped);
+    printf("board: %dx%d, seed: %llu\n", config->cols, config->rows, (unsigned long long)opts->seed);
+    printf("score: mean %.2f, min %d, max %d\n",
+           opts->games > 0 ? (double)scoreSum / opts->games : 0.0, minScore, maxScore);
+    printf("frames: %llu, moves: %llu, elapsed: %.3f s\n", totalFrames, totalMoves, seconds);
+    printf("ticks/sec: %.0f\n", (double)totalFrames / seconds);
+    printf("moves/sec: %.0f\n", (double)totalMoves / seconds);
+
+    destroyGameState(gs);
+    free(in.keys);
+    return 0;
+}
@@ -0,0 +1,61 @@
+#ifndef HEADLESS_H
+#define HEADLESS_H
+
+// Headless simulation: runs the game loop with no curses, sleeping or
+// rendering, so raw engine throughput can be measured and rule changes soaked.
+
+#include "game.h"
+
+#define DEFAULT_HEADLESS_GAMES 100
+#define DEFAULT_HEADLESS_MAX_FRAMES 1000000
+
+typedef struct {
+    int games;               // Games to play back to back
+    int maxFrames;           // Per-game frame cap so a lucky autopilot still ends
+    const char *scriptPath;  // Keys fed one per move, NULL for the random autopilot
+    int quiet;               // Print only the summary, not every game
+    uint64_t seed;           // Base seed, see headlessGameSeed()
+} HeadlessOptions;
+
+// Outcome of one headless game
+typedef struct {
+    int score;
+    int length;
+    long frames;
+    long moves;
+    int capped;  // Stopped by the frame cap rather than a game over
+} GameResult;
+
+// Steering for headless games: keys from a script, or the random autopilot
+// when keys is NULL. Start from { NULL, 0, 0, { 0, 0 } }.
+typedef struct {
+    char *keys;       // Script contents, NULL for the random autopilot, owned by the caller
+    long length;
+    long position;    // Next key to feed, wraps around at the end
+    Rng rng;          // Autopilot random state, separate from the game's own
+} InputSource;
+
+HeadlessOptions defaultHeadlessOptions(void);
+
+// Load a key script into in. Returns 0 (after printing why) on failure.
+int loadInputScript(InputSource *in, const char *path);
+
+// Rewind the script and reseed the autopilot for a game played with seed
+void restartInput(InputSource *in, uint64_t seed);
+
+// Steer gs for its next move; call when moveDueNextFrame(gs) says one is due
+void steerFromInput(GameState *gs, InputSource *in);
+
+// Seed for game number index of a run started with baseSeed. Every game in a
+// run gets a well-mixed seed of its own, whichever thread ends up playing it.
+uint64_t headlessGameSeed(uint64_t baseSeed, uint32_t index);
+
+// Reseed gs and the random autopilot from seed, then play one game to the end
+// or to maxFrames. The result depends only on the config, seed and maxFrames.
+GameResult playAutopilotGame(GameState *gs, uint64_t seed, int maxFrames);
+
+// Play opts->games games and print per-game results plus ticks/sec and
+// moves/sec to stdout. Returns 0 on success, 1 on setup failure.
+int runHeadless(const GameConfig *config, const HeadlessOptions *opts);
+
+#endif // HEADLESS_H
@@ -0,0 +1,37 @@
+#ifndef LATENCY_H
+#define LATENCY_H
+
+// Input latency instrumentation for interactive play. Every key is stamped
+// when main() reads it; the latency to the move that applies it and to the
+// flushed frame that shows it goes into log-linear histograms, printed to
+// stderr on exit and on SIGUSR1.
+//
+// Only compiled in with -DSNAKE_LATENCY (make latency). Otherwise every
+// function below is an empty inline and the calls compile away.
+
+#include "game.h"
+
+#ifdef SNAKE_LATENCY
+
+void latencyInit(void);
+// Call after advanceFrame(). Picks up a turn the move applied, from the
+// key's queueTurn() stamp (monotonicNs() time).
+void latencyAfterTick(GameState *gs);
+// Call after a frame was flushed to the terminal, it shows every turn
+// applied before it
+void latencyFrameShown(void);
+// Print the histograms if SIGUSR1 asked for them
+void latencyPoll(void);
+void latencyDump(void);
+
+#else
+
+static inline void latencyInit(void) {}
+static inline void latencyAfterTick(GameState *gs) { (void)gs; }
+static inline void latencyFrameShown(void) {}
+static inline void latencyPoll(void) {}
+static inline void latencyDump(void) {}
+
+#endif // SNAKE_LATENCY
+
+#endif // LATENCY_H
@@ -0,0 +1,40 @@
+// Command line value parsing, see options.h
+#include "options.h"
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// Parse an integer option value into *out, checking it lies in [min, max]
+int parseIntOption(const char *name, const char *value, int min, int max, int *out) {
+    char *end;
+    long v;
+    if (!value) {
+        fprintf(stderr, "Missing value for %s\n", name);
+        return 0;
+    }
+    v = strtol(value, &end, 10);
+    if (*value == '\0' || *end != '\0' || v < min || v > max) {
+        fprintf(stderr, "Invalid value for %s: %s (expected %d-%d)\n", name, value, min, max);
+        return 0;
+    }
+    *out = (int)v;
+    return 1;
+}
+
+// Parse an unsigned 64-bit seed
+int parseSeedOption(const char *name, const char *value, uint64_t *out) {
+    char *end;
+    unsigned long long v;
+    if (!value) {
+        fprintf(stderr, "Missing value for %s\n", name);
+        return 0;
+    }
+    errno = 0;
+    v = strtoull(value, &end, 0);
+    if (*value == '\0' || *value == '-' || *end != '\0' || errno == ERANGE) {
+        fprintf(stderr, "Invalid value for %s: %s (expected 0-18446744073709551615)\n", name, value);
+        return 0;
+    }
+    *out = (uint64_t)v;
+    return 1;
+}
@@ -0,0 +1,15 @@
+#ifndef OPTIONS_H
+#define OPTIONS_H
+
+// Command line values shared by the game and the benchmarks. Both print
+// what was wrong and return 0 on a missing or invalid value.
+
+#include <stdint.h>
+
+// Parse an integer option value into *out, checking it lies in [min, max]
+int parseIntOption(const char *name, const char *value, int min, int max, int *out);
+
+// Parse an unsigned 64-bit seed
+int parseSeedOption(const char *name, const char *value, uint64_t *out);
+
+#endif // OPTIONS_H
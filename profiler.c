@@ -0,0 +1,124 @@
+// Per-phase frame profiler, see profiler.h
+#include "profiler.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *const phaseNames[PHASE_COUNT] = { "input", "move", "events", "draw", "wait" };
+static const char *const phaseShortNames[PHASE_COUNT] = { "in", "mv", "ev", "draw", "wait" };
+
+int profilerEnabled = 0;
+
+static struct {
+    uint64_t current[PHASE_COUNT];               // Frame being measured, ns
+    uint32_t window[PHASE_COUNT][PROFILE_WINDOW]; // Recent frames, us
+    int windowCount;
+    int windowPos;
+    unsigned long frames;
+    int hudVisible;
+    char hud[128];
+    FILE *csv;
+} prof;
+
+static void formatHud(char *buf, size_t size);
+
+static void updateEnabled(void) {
+    int wasEnabled = profilerEnabled;
+    profilerEnabled = prof.hudVisible || prof.csv != NULL;
+    // Do not charge time measured before a pause to the next frame
+    if (!wasEnabled) memset(prof.current, 0, sizeof(prof.current));
+}
+
+void profileAdd(ProfilePhase phase, uint64_t ns) {
+    prof.current[phase] += ns;
+}
+
+int profilerOpenCsv(const char *path) {
+    prof.csv = fopen(path, "w");
+    if (!prof.csv) {
+        fprintf(stderr, "Cannot create profile file %s\n", path);
+        return 0;
+    }
+    fprintf(prof.csv, "frame,ticks");
+    for (int p = 0; p < PHASE_COUNT; p++) fprintf(prof.csv, ",%s_ns", phaseNames[p]);
+    fprintf(prof.csv, ",total_ns\n");
+    updateEnabled();
+    return 1;
+}
+
+void profilerClose(void) {
+    if (prof.csv) fclose(prof.csv);
+    prof.csv = NULL;
+    updateEnabled();
+}
+
+void profilerToggleHud(void) {
+    prof.hudVisible = !prof.hudVisible;
+    prof.hud[0] = '\0';
+    updateEnabled();
+}
+
+int profilerHudVisible(void) {
+    return prof.hudVisible;
+}
+
+int profilerEndFrame(int ticks) {
+    if (!profilerEnabled) return 0;
+    if (ticks == 0) {
+        // Only the wait before the very first tick, not a frame
+        memset(prof.current, 0, sizeof(prof.current));
+        return 0;
+    }
+    uint64_t total = 0;
+    for (int p = 0; p < PHASE_COUNT; p++) total += prof.current[p];
+
+    if (prof.csv) {
+        fprintf(prof.csv, "%lu,%d", prof.frames, ticks);
+        for (int p = 0; p < PHASE_COUNT; p++)
+            fprintf(prof.csv, ",%llu", (unsigned long long)prof.current[p]);
+        fprintf(prof.csv, ",%llu\n", (unsigned long long)total);
+    }
+
+    for (int p = 0; p < PHASE_COUNT; p++) {
+        uint64_t us = prof.current[p] / 1000;
+        prof.window[p][prof.windowPos] = us > UINT32_MAX ? UINT32_MAX : (uint32_t)us;
+    }
+    prof.windowPos = (prof.windowPos + 1) % PROFILE_WINDOW;
+    if (prof.windowCount < PROFILE_WINDOW) prof.windowCount++;
+    memset(prof.current, 0, sizeof(prof.current));
+    prof.frames++;
+
+    // Refresh the HUD text now and then; right away after it was switched on
+    if (!prof.hudVisible || (prof.hud[0] && prof.frames % PROFILE_HUD_PERIOD != 0)) return 0;
+    formatHud(prof.hud, sizeof(prof.hud));
+    return 1;
+}
+
+const char *profilerHudText(void) {
+    return prof.hud;
+}
+
+static int compareU32(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+static void formatHud(char *buf, size_t size) {
+    uint32_t sorted[PROFILE_WINDOW];
+    int n = prof.windowCount;
+    size_t len = (size_t)snprintf(buf, size, "us avg/p99");
+
+    for (int p = 0; p < PHASE_COUNT && len < size; p++) {
+        unsigned long long sum = 0;
+        unsigned long avg = 0, p99 = 0;
+        if (n > 0) {
+            memcpy(sorted, prof.window[p], (size_t)n * sizeof(uint32_t));
+            qsort(sorted, (size_t)n, sizeof(uint32_t), compareU32);
+            for (int i = 0; i < n; i++) sum += sorted[i];
+            avg = (unsigned long)(sum / (unsigned long long)n);
+            p99 = sorted[(n * 99 + 99) / 100 - 1];
+        }
+        len += (size_t)snprintf(buf + len, size - len, "  %s %lu/%lu", phaseShortNames[p], avg, p99);
+    }
+}
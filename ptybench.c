@@ -0,0 +1,460 @@
+// Terminal output benchmark. Each renderer configuration draws a scripted
+// game into a pseudo-terminal whose other end is drained by a thread, so no
+// real terminal is needed. It reports what reaches the tty: bytes, escape
+// sequences and write syscalls per drawn frame, and the wall time spent
+// drawing. Results go to stdout as JSON. Build with "make ptybench", then
+// run ./snake-ptybench > pty.json.
+//
+// Every configuration runs in a forked child so that curses starts fresh.
+// Bytes and escapes are counted as they come out of the pty. Write syscalls
+// come from /proc/self/io, so this needs Linux.
+#ifdef __linux__
+    #define _GNU_SOURCE  // cfmakeraw
+#else
+    #define _DARWIN_C_SOURCE
+#endif
+#include "game.h"
+#include "headless.h"
+#include "options.h"
+#include "render.h"
+#include "timing.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/wait.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#ifdef __linux__
+    #include <pty.h>
+#else
+    #include <util.h>
+#endif
+
+#define DEFAULT_PTY_TICKS 10000  // 100 seconds of play at 100 ticks per second
+#define DEFAULT_PTY_SEED 1
+#define MAX_PTY_TICKS 100000000
+#define FULL_REDRAWS 20          // Wiped-screen repaints timed after the game
+#define ESC_BYTE 0x1b
+#define MARK_BYTE 0x00           // Phase boundary written into the pty, renderers never send NUL
+#define DRAIN_TIMEOUT_SEC 10     // Give up if a mark has not come through the pty by then
+
+// One renderer setup to measure
+typedef struct {
+    const char *renderer;
+    int boostRefreshFrames;
+    int drawEvery;  // Ticks per drawFrame() call, 1 draws every tick like the default --fps
+} PtyConfig;
+
+static const PtyConfig configs[] = {
+    { "curses", DEFAULT_BOOST_REFRESH, 1 },
+    { "curses", 1, 1 },
+    { "curses", DEFAULT_BOOST_REFRESH, 5 },
+    { "ansi", DEFAULT_BOOST_REFRESH, 1 },
+    { "ansi", 1, 1 },
+    { "ansi", DEFAULT_BOOST_REFRESH, 5 },
+};
+
+typedef struct {
+    int ticks;
+    uint64_t seed;
+    const char *scriptPath;
+    GameConfig game;
+    struct winsize size;
+} PtyOptions;
+
+// Terminal traffic of one phase
+typedef struct {
+    long long bytes;
+    long long escapes;
+    long long writes;
+    uint64_t ns;
+} Traffic;
+
+// Sent from the child back to the parent
+typedef struct {
+    int ok;
+    Traffic startup;    // Renderer creation: terminal setup, chrome and first paint
+    Traffic frames;     // The scripted game
+    Traffic redraws;    // FULL_REDRAWS wiped-screen repaints
+    long drawCalls;
+    long drawnFrames;   // drawFrame() calls that wrote anything
+    long games;
+    long long maxFrameBytes;
+    uint64_t maxFrameNs;
+} PtyResult;
+
+/* ------------------ DRAINER ------------------*/
+// Reads everything the renderer sends to the terminal, counting bytes and
+// escape sequences, so writes never block on a full pty buffer. Mark bytes
+// are counted apart: when the reader has seen a mark, it has seen all the
+// output written before it.
+typedef struct {
+    int master;
+    pthread_mutex_t lock;
+    pthread_cond_t progress;
+    long long bytes;
+    long long escapes;
+    long marks;
+    int done;
+    long marksSent;  // Only touched by the writing thread
+} Drainer;
+
+static void *drainMain(void *arg) {
+    Drainer *d = arg;
+    unsigned char buf[16384];
+    for (;;) {
+        ssize_t n = read(d->master, buf, sizeof(buf));
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;  // EIO once the slave side is closed
+        long long escapes = 0;
+        long marks = 0;
+        for (ssize_t i = 0; i < n; i++) {
+            escapes += buf[i] == ESC_BYTE;
+            marks += buf[i] == MARK_BYTE;
+        }
+        pthread_mutex_lock(&d->lock);
+        d->bytes += n - marks;
+        d->escapes += escapes;
+        d->marks += marks;
+        pthread_cond_broadcast(&d->progress);
+        pthread_mutex_unlock(&d->lock);
+    }
+    pthread_mutex_lock(&d->lock);
+    d->done = 1;
+    pthread_cond_broadcast(&d->progress);
+    pthread_mutex_unlock(&d->lock);
+    return NULL;
+}
+
+// Write a mark into the pty and wait until the drainer has read it, so it
+// has also read everything written before. Returns 0 if the mark does not
+// arrive within DRAIN_TIMEOUT_SEC.
+static int drainToMark(Drainer *d, long long *bytes, long long *escapes) {
+    static const unsigned char mark = MARK_BYTE;
+    if (write(STDOUT_FILENO, &mark, 1) != 1) return 0;
+    long target = ++d->marksSent;
+
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += DRAIN_TIMEOUT_SEC;
+    int timedOut = 0;
+    pthread_mutex_lock(&d->lock);
+    while (d->marks < target && !d->done && !timedOut)
+        timedOut = pthread_cond_timedwait(&d->progress, &d->lock, &deadline) == ETIMEDOUT;
+    int arrived = d->marks >= target;
+    *bytes = d->bytes;
+    *escapes = d->escapes;
+    pthread_mutex_unlock(&d->lock);
+    return arrived;
+}
+
+/* ------------------ MEASUREMENT ------------------*/
+// Marks the start of a phase. Bytes and escapes are what the drainer read,
+// so output to other files does not count. Write syscalls come from the
+// kernel and are read before the mark goes out.
+typedef struct {
+    IoCounters io;
+    long long bytes;
+    long long escapes;
+    uint64_t ns;
+} Mark;
+
+static int markNow(Mark *m, Drainer *d) {
+    m->ns = 0;
+    return readIoCounters(&m->io) && drainToMark(d, &m->bytes, &m->escapes);
+}
+
+// Close the phase begun at from, and start the next one from here. Returns 0
+// if the pty output could not be drained.
+static int endPhase(Traffic *t, Mark *from, Drainer *d) {
+    Mark now;
+    if (!markNow(&now, d)) return 0;
+    t->bytes = now.bytes - from->bytes;
+    t->writes = now.io.writes - from->io.writes - 1;  // Less the mark written by from
+    t->escapes = now.escapes - from->escapes;
+    t->ns = from->ns;
+    *from = now;
+    return 1;
+}
+
+/* ------------------ CHILD ------------------*/
+static void reportStall(void) {
+    fprintf(stderr, "Terminal output did not come through the pty within %d seconds\n", DRAIN_TIMEOUT_SEC);
+}
+
+static Renderer *createRenderer(const PtyConfig *cfg, const GameConfig *game) {
+    RenderOptions opts = { cfg->boostRefreshFrames, 0 };
+    if (strcmp(cfg->renderer, "ansi") == 0) return createAnsiRenderer(game, &opts);
+    return createCursesRenderer(game, &opts);
+}
+
+// Play the scripted game into the renderer, restarting after each game over
+// like a player pressing R, until opts->ticks ticks have run
+static void playScript(Renderer *r, GameState *gs, InputSource *in, const PtyConfig *cfg,
+                       const PtyOptions *opts, PtyResult *res, Mark *phase) {
+    uint64_t seed = opts->seed;
+    restartInput(in, seed);
+    for (int tick = 1; tick <= opts->ticks; tick++) {
+        if (gs->gameOver) {
+            r->drawGameOver(r, gs);
+            seed = headlessGameSeed(opts->seed, (uint32_t)++res->games);
+            seedGameState(gs, seed);
+            resetGameState(gs);
+            restartInput(in, seed);
+            r->redraw(r);
+        }
+        if (moveDueNextFrame(gs)) steerFromInput(gs, in);
+        advanceFrame(gs);
+        if (tick % cfg->drawEvery != 0) continue;
+
+        IoCounters before, after;
+        readIoCounters(&before);
+        uint64_t start = monotonicNs();
+        r->drawFrame(r, gs);
+        uint64_t ns = monotonicNs() - start;
+        readIoCounters(&after);
+
+        long long bytes = after.bytes - before.bytes;
+        res->drawCalls++;
+        if (bytes > 0) res->drawnFrames++;
+        if (bytes > res->maxFrameBytes) res->maxFrameBytes = bytes;
+        if (ns > res->maxFrameNs) res->maxFrameNs = ns;
+        phase->ns += ns;
+    }
+}
+
+static void runConfig(const PtyConfig *cfg, const PtyOptions *opts, InputSource *in, PtyResult *res) {
+    int master, slave;
+    struct termios raw;
+    struct winsize size = opts->size;
+    memset(&raw, 0, sizeof(raw));
+    cfmakeraw(&raw);  // No output processing: the master reads exactly what was written
+    if (openpty(&master, &slave, NULL, &raw, &size) != 0) {
+        fprintf(stderr, "Cannot open a pseudo-terminal: %s\n", strerror(errno));
+        return;
+    }
+
+    Drainer drainer = { master, PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, 0, 0, 0, 0, 0 };
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, drainMain, &drainer) != 0) {
+        fprintf(stderr, "Cannot start the pty reader\n");
+        return;
+    }
+
+    // The renderers talk to stdin and stdout
+    dup2(slave, STDIN_FILENO);
+    dup2(slave, STDOUT_FILENO);
+    close(slave);
+
+    GameState *gs = createGameState(&opts->game, opts->seed);
+    if (!gs) {
+        fprintf(stderr, "Cannot create a %dx%d game\n", opts->game.cols, opts->game.rows);
+        return;
+    }
+
+    // A stalled reader would soon block the renderer on a full pty, so give
+    // up on the configuration at the first mark that does not come through
+    Mark phase;
+    if (!markNow(&phase, &drainer)) {
+        reportStall();
+        return;
+    }
+    uint64_t start = monotonicNs();
+    Renderer *r = createRenderer(cfg, &opts->game);
+    if (!r) return;
+    r->drawFrame(r, gs);
+    phase.ns = monotonicNs() - start;
+    if (!endPhase(&res->startup, &phase, &drainer)) {
+        reportStall();
+        return;
+    }
+
+    playScript(r, gs, in, cfg, opts, res, &phase);
+    if (!endPhase(&res->frames, &phase, &drainer)) {
+        reportStall();
+        return;
+    }
+
+    for (int i = 0; i < FULL_REDRAWS; i++) {
+        start = monotonicNs();
+        r->redraw(r);
+        r->drawFrame(r, gs);
+        phase.ns += monotonicNs() - start;
+    }
+    if (!endPhase(&res->redraws, &phase, &drainer)) {
+        reportStall();
+        return;
+    }
+
+    r->destroy(r);
+    fflush(stdout);
+    destroyGameState(gs);
+
+    // Hang up the slave side so the reader sees EIO and finishes
+    int devNull = open("/dev/null", O_RDWR);
+    dup2(devNull, STDIN_FILENO);
+    dup2(devNull, STDOUT_FILENO);
+    close(devNull);
+    pthread_join(thread, NULL);
+    close(master);
+    res->ok = 1;
+}
+
+// Run one configuration in a child process and collect its result
+static int measureConfig(const PtyConfig *cfg, const PtyOptions *opts, InputSource *in, PtyResult *res) {
+    int fds[2];
+    memset(res, 0, sizeof(*res));
+    if (pipe(fds) != 0) return 0;
+    fflush(stdout);
+    fflush(stderr);
+
+    pid_t pid = fork();
+    if (pid < 0) {
+        close(fds[0]);
+        close(fds[1]);
+        return 0;
+    }
+    if (pid == 0) {
+        close(fds[0]);
+        PtyResult child;
+        memset(&child, 0, sizeof(child));
+        runConfig(cfg, opts, in, &child);
+        ssize_t n = write(fds[1], &child, sizeof(child));
+        _exit(n == (ssize_t)sizeof(child) ? 0 : 1);
+    }
+
+    close(fds[1]);
+    size_t got = 0;
+    while (got < sizeof(*res)) {
+        ssize_t n = read(fds[0], (char *)res + got, sizeof(*res) - got);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        got += (size_t)n;
+    }
+    close(fds[0]);
+    waitpid(pid, NULL, 0);
+    return got == sizeof(*res) && res->ok;
+}
+
+/* ------------------ REPORT ------------------*/
+static double perUnit(double value, long units) {
+    return units > 0 ? value / (double)units : 0.0;
+}
+
+static void printResult(const PtyConfig *cfg, const PtyResult *res, int first) {
+    const Traffic *f = &res->frames;
+    const Traffic *s = &res->startup;
+    const Traffic *rd = &res->redraws;
+    printf("%s\n    { \"renderer\": \"%s\", \"boost_refresh\": %d, \"draw_every\": %d, \"games\": %ld,\n",
+           first ? "" : ",", cfg->renderer, cfg->boostRefreshFrames, cfg->drawEvery, res->games + 1);
+    printf("      \"startup\": { \"bytes\": %lld, \"escapes\": %lld, \"writes\": %lld, \"us\": %.1f },\n",
+           s->bytes, s->escapes, s->writes, (double)s->ns / 1000.0);
+    printf("      \"frames\": { \"draw_calls\": %ld, \"drawn\": %ld, \"bytes_per_frame\": %.1f, "
+           "\"escapes_per_frame\": %.1f, \"writes_per_frame\": %.3f, \"ns_per_frame\": %.0f, "
+           "\"max_bytes\": %lld, \"max_ns\": %llu },\n",
+           res->drawCalls, res->drawnFrames, perUnit((double)f->bytes, res->drawnFrames),
+           perUnit((double)f->escapes, res->drawnFrames), perUnit((double)f->writes, res->drawnFrames),
+           perUnit((double)f->ns, res->drawnFrames), res->maxFrameBytes,
+           (unsigned long long)res->maxFrameNs);
+    printf("      \"full_redraw\": { \"count\": %d, \"bytes\": %.1f, \"escapes\": %.1f, "
+           "\"writes\": %.3f, \"ns\": %.0f } }",
+           FULL_REDRAWS, perUnit((double)rd->bytes, FULL_REDRAWS), perUnit((double)rd->escapes, FULL_REDRAWS),
+           perUnit((double)rd->writes, FULL_REDRAWS), perUnit((double)rd->ns, FULL_REDRAWS));
+}
+
+static void printUsage(const char *prog) {
+    fprintf(stderr,
+        "Usage: %s [options] > results.json\n"
+        "  --ticks N        Game ticks to play per configuration (default %d, 1-%d)\n"
+        "  --seed N         Seed of the scripted game (default %d)\n"
+        "  --script FILE    Steer with keys from FILE instead of the random autopilot\n"
+        "  --cols N         Board width (default %d, %d-%d)\n"
+        "  --rows N         Board height (default %d, %d-%d)\n",
+        prog, DEFAULT_PTY_TICKS, MAX_PTY_TICKS, DEFAULT_PTY_SEED,
+        DEFAULT_COLS, MIN_BOARD_DIM, MAX_BOARD_DIM, DEFAULT_ROWS, MIN_BOARD_DIM, MAX_BOARD_DIM);
+}
+
+int main(int argc, char **argv) {
+    PtyOptions opts;
+    memset(&opts, 0, sizeof(opts));
+    opts.ticks = DEFAULT_PTY_TICKS;
+    opts.seed = DEFAULT_PTY_SEED;
+    opts.game = defaultGameConfig();
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+        int ok;
+        if (strcmp(arg, "--ticks") == 0) {
+            ok = parseIntOption(arg, value, 1, MAX_PTY_TICKS, &opts.ticks);
+        } else if (strcmp(arg, "--seed") == 0) {
+            ok = parseSeedOption(arg, value, &opts.seed);
+        } else if (strcmp(arg, "--script") == 0) {
+            ok = value != NULL;
+            opts.scriptPath = value;
+        } else if (strcmp(arg, "--cols") == 0) {
+            ok = parseIntOption(arg, value, MIN_BOARD_DIM, MAX_BOARD_DIM, &opts.game.cols);
+        } else if (strcmp(arg, "--rows") == 0) {
+            ok = parseIntOption(arg, value, MIN_BOARD_DIM, MAX_BOARD_DIM, &opts.game.rows);
+        } else {
+            ok = 0;
+        }
+        if (!ok) {
+            printUsage(argv[0]);
+            return 1;
+        }
+        i++;
+    }
+    if (!validateGameConfig(&opts.game)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    IoCounters probe;
+    if (!readIoCounters(&probe)) {
+        fprintf(stderr, "Terminal I/O counts are not available on this platform\n");
+        return 1;
+    }
+
+    InputSource in = { NULL, 0, 0, { 0, 0 } };
+    if (opts.scriptPath && !loadInputScript(&in, opts.scriptPath)) return 1;
+
+    // Room for the board, the instructions panel to its right and the HUD row
+    opts.size.ws_col = (unsigned short)(instructionsLeft(&opts.game) + 40);
+    opts.size.ws_row = (unsigned short)(hudRow(&opts.game) + 1 > 24 ? hudRow(&opts.game) + 1 : 24);
+
+    // Curses sizes itself from the pty, not a stale environment
+    unsetenv("LINES");
+    unsetenv("COLUMNS");
+    const char *term = getenv("TERM");
+    if (!term || !*term || strcmp(term, "dumb") == 0) setenv("TERM", "xterm", 1);
+
+    printf("{\n  \"board\": { \"cols\": %d, \"rows\": %d },\n", opts.game.cols, opts.game.rows);
+    printf("  \"terminal\": { \"cols\": %d, \"rows\": %d, \"term\": \"%s\" },\n",
+           opts.size.ws_col, opts.size.ws_row, getenv("TERM"));
+    printf("  \"ticks\": %d,\n  \"seed\": %llu,\n  \"script\": %s%s%s,\n", opts.ticks,
+           (unsigned long long)opts.seed, opts.scriptPath ? "\"" : "",
+           opts.scriptPath ? opts.scriptPath : "null", opts.scriptPath ? "\"" : "");
+    printf("  \"results\": [");
+
+    int first = 1;
+    int failed = 0;
+    for (size_t i = 0; i < sizeof(configs) / sizeof(configs[0]); i++) {
+        PtyResult res;
+        if (!measureConfig(&configs[i], &opts, &in, &res)) {
+            fprintf(stderr, "Configuration %s (boost refresh %d, draw every %d) failed\n",
+                    configs[i].renderer, configs[i].boostRefreshFrames, configs[i].drawEvery);
+            failed = 1;
+            continue;
+        }
+        printResult(&configs[i], &res, first);
+        first = 0;
+    }
+    printf("\n  ]\n}\n");
+    free(in.keys);
+    return failed;
+}
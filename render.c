@@ -0,0 +1,197 @@
+// Pieces shared by the renderer backends: board diffing against the last
+// drawn frame, the text laid out around the board, and I/O statistics.
+#ifndef _WIN32
+    #define _POSIX_C_SOURCE 200809L  // snprintf and strtoll under -std=c11
+#endif
+#include "render.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define GLYPH_UNKNOWN 0xFF  // BoardView.drawn[] value when the screen contents are not known
+
+/* ------------------ BOARD VIEW ------------------*/
+// Glyph for each CellType; the head is told apart separately
+static const unsigned char cellGlyph[] = {
+    [CELL_EMPTY]            = GLYPH_EMPTY,
+    [CELL_BODY]             = GLYPH_SNAKE_BODY,
+    [CELL_FOOD]             = GLYPH_FOOD,
+    [CELL_TEMP_FOOD]        = GLYPH_TEMP_FOOD,
+    [CELL_TEMP_FOOD_DOUBLE] = GLYPH_TEMP_FOOD_DOUBLE,
+    [CELL_TEMP_FOOD_TRIPLE] = GLYPH_TEMP_FOOD_TRIPLE,
+    [CELL_SPECIAL]          = GLYPH_SPECIAL_ITEM,
+    [CELL_DEATH]            = GLYPH_DEATH_ITEM,
+};
+
+static inline unsigned char cellLook(const GameState *gs, int cell, int headCell) {
+    return cell == headCell ? GLYPH_SNAKE_HEAD : cellGlyph[gs->cellMap[cell]];
+}
+
+int boardViewInit(BoardView *v, const GameConfig *config, int boostRefreshFrames) {
+    memset(v, 0, sizeof(*v));
+    v->cells = config->rows * config->cols;
+    v->boostRefreshFrames = boostRefreshFrames;
+    v->drawn = malloc((size_t)v->cells);
+    if (!v->drawn) return 0;
+    boardViewInvalidate(v);
+    return 1;
+}
+
+void boardViewFree(BoardView *v) {
+    free(v->drawn);
+    v->drawn = NULL;
+}
+
+void boardViewInvalidate(BoardView *v) {
+    memset(v->drawn, GLYPH_UNKNOWN, (size_t)v->cells);
+    v->drawnHead = -1;
+    v->stale = 1;
+    v->redrawAll = 1;
+}
+
+int boardViewBegin(BoardView *v, const GameState *gs) {
+    v->frames++;
+    // The boost countdown ticks every frame, so it only forces a redraw
+    // every boostRefreshFrames frames
+    int countdownDue = gs->speedBoostActive &&
+                       gs->frame - v->statusFrame >= (uint64_t)v->boostRefreshFrames;
+    if (!v->stale && gs->version == v->drawnVersion && !countdownDue) return 0;
+    v->drawnVersion = gs->version;
+    v->statusFrame = gs->frame;
+    v->stale = 0;
+    v->drawnFrames++;
+    return 1;
+}
+
+// Draw one board cell if its look changed since it was last drawn
+static inline void updateCell(BoardView *v, const GameState *gs, int cell, int headCell,
+                              DrawCellFn drawCell, void *ctx) {
+    unsigned char look = cellLook(gs, cell, headCell);
+    if (v->drawn[cell] != look) {
+        drawCell(ctx, cell, (GlyphId)look);
+        v->drawn[cell] = look;
+    }
+}
+
+void boardViewUpdate(BoardView *v, GameState *gs, DrawCellFn drawCell, void *ctx) {
+    int headCell = (int)snakeHeadCell(gs);
+    if (gs->dirtyOverflow || v->redrawAll) {
+        for (int cell = 0; cell < v->cells; cell++)
+            updateCell(v, gs, cell, headCell, drawCell, ctx);
+    } else {
+        for (int i = 0; i < gs->dirtyCount; i++)
+            updateCell(v, gs, (int)gs->dirtyCells[i], headCell, drawCell, ctx);
+        // The head moving changes two cells without changing their CellType
+        if (v->drawnHead >= 0 && v->drawnHead != headCell)
+            updateCell(v, gs, v->drawnHead, headCell, drawCell, ctx);
+        updateCell(v, gs, headCell, headCell, drawCell, ctx);
+    }
+    v->drawnHead = headCell;
+    v->redrawAll = 0;
+    clearDirtyCells(gs);
+}
+
+/* ------------------ TEXT AROUND THE BOARD ------------------*/
+const char *const instructionRows[INSTRUCTION_ROWS] = {
+    "=== SNAKE GAME ===",
+    NULL,
+    "Controls:",
+    "W/A/S/D - Move",
+    NULL,
+    "Items:",
+    "* - Food (+1, +2 w/boost)",
+    "T - Temp Food (+2)",
+    "D - Double Food (+4)",
+    "X - Triple Food (+6)",
+    "$ - Speed + Double Points",
+    NULL,
+    "Avoid:",
+    "X - Death Item",
+    "Walls & Self",
+};
+
+int instructionsTop(void) {
+    return 2;
+}
+
+int instructionsLeft(const GameConfig *config) {
+    return config->cols + 5; // Start 3 spaces after the game border
+}
+
+int formatStatus(const GameState *gs, TextLine *parts) {
+    int score = gameScore(gs);
+    int count = 0;
+    TextLine *p = &parts[count++];
+
+    p->row = gs->config.rows + 3;
+    p->col = 0;
+    if (gs->speedBoostActive) {
+        p->attr = ATTR_SUCCESS; // Green text for speed boost
+        snprintf(p->text, sizeof(p->text), "Score: %d | SPEED BOOST: %d frames",
+                 score, speedBoostFramesLeft(gs));
+    } else {
+        p->attr = ATTR_TEXT;
+        snprintf(p->text, sizeof(p->text), "Score: %d", score);
+    }
+
+    if (gs->boardFull) {
+        TextLine *warn = &parts[count++];
+        warn->row = p->row;
+        warn->col = p->col + (int)strlen(p->text);
+        warn->attr = ATTR_WARNING;
+        snprintf(warn->text, sizeof(warn->text), " | BOARD FULL");
+    }
+    return count;
+}
+
+int hudRow(const GameConfig *config) {
+    return config->rows + 4;
+}
+
+void formatGameOver(const GameState *gs, TextLine *lines) {
+    int rows = gs->config.rows;
+    int cols = gs->config.cols;
+    TextLine gameOver[GAME_OVER_LINES] = {
+        { rows / 2,     cols / 2 - 5,  ATTR_ERROR, "GAME OVER!" },
+        { rows / 2 + 1, cols / 2 - 7,  ATTR_TEXT,  "" },
+        { rows / 2 + 3, cols / 2 - 10, ATTR_TEXT,  "Press R to Restart" },
+        { rows / 2 + 4, cols / 2 - 8,  ATTR_TEXT,  "Press Q to Quit" },
+    };
+    snprintf(gameOver[1].text, sizeof(gameOver[1].text), "Final Score: %d", gameScore(gs));
+    memcpy(lines, gameOver, sizeof(gameOver));
+}
+
+/* ------------------ I/O STATISTICS ------------------*/
+static long long ioField(const char *text, const char *name) {
+    const char *field = strstr(text, name);
+    return field ? strtoll(field + strlen(name), NULL, 10) : -1;
+}
+
+int readIoCounters(IoCounters *io) {
+#ifdef __linux__
+    char buf[512];
+    FILE *f = fopen("/proc/self/io", "r");
+    if (!f) return 0;
+    size_t n = fread(buf, 1, sizeof(buf) - 1, f);
+    fclose(f);
+    buf[n] = '\0';
+    io->bytes = ioField(buf, "wchar:");
+    io->writes = ioField(buf, "syscw:");
+    io->reads = ioField(buf, "syscr:");
+    return io->bytes >= 0 && io->writes >= 0 && io->reads >= 0;
+#else
+    (void)io;
+    (void)ioField;
+    return 0;
+#endif
+}
+
+void printRenderStats(const char *name, const BoardView *v, long long bytes, long long maxBytes,
+                      long long writes, long long reads) {
+    double frames = v->frames ? (double)v->frames : 1.0;
+    fprintf(stderr, "renderer: %s, frames: %lu, drawn: %lu\n", name, v->frames, v->drawnFrames);
+    fprintf(stderr, "bytes/frame: %.1f", (double)bytes / frames);
+    if (maxBytes >= 0) fprintf(stderr, " (max %lld)", maxBytes);
+    fprintf(stderr, ", write calls/frame: %.3f, read calls/frame: %.3f\n",
+            (double)writes / frames, (double)reads / frames);
+}
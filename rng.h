@@ -0,0 +1,57 @@
+#ifndef RNG_H
+#define RNG_H
+
+// Small deterministic random number generator (PCG32, XSH-RR variant).
+// Every game, autopilot and worker owns one, so no state is shared, and
+// only fixed-width integer arithmetic is used: the same seed gives the same
+// sequence on every compiler and platform.
+
+#include <stdint.h>
+
+typedef struct {
+    uint64_t state;
+    uint64_t inc;  // Stream selector, always odd
+} Rng;
+
+static inline uint32_t rngNext(Rng *r) {
+    uint64_t old = r->state;
+    r->state = old * 6364136223846793005ull + r->inc;
+    uint32_t xorshifted = (uint32_t)(((old >> 18u) ^ old) >> 27u);
+    uint32_t rot = (uint32_t)(old >> 59u);
+    return (xorshifted >> rot) | (xorshifted << ((-rot) & 31u));
+}
+
+// Seed a generator. Different streams give independent sequences for the
+// same seed.
+static inline void rngSeed(Rng *r, uint64_t seed, uint64_t stream) {
+    r->state = 0;
+    r->inc = (stream << 1u) | 1u;
+    rngNext(r);
+    r->state += seed;
+    rngNext(r);
+}
+
+// Uniform value in [0, bound) without modulo bias (Lemire's multiply-shift
+// with rejection). bound must be non-zero.
+static inline uint32_t rngBelow(Rng *r, uint32_t bound) {
+    uint64_t m = (uint64_t)rngNext(r) * bound;
+    uint32_t low = (uint32_t)m;
+    if (low < bound) {
+        uint32_t threshold = (0u - bound) % bound;
+        while (low < threshold) {
+            m = (uint64_t)rngNext(r) * bound;
+            low = (uint32_t)m;
+        }
+    }
+    return (uint32_t)(m >> 32);
+}
+
+// SplitMix64 step, used to derive well-spread seeds from a base seed
+static inline uint64_t mixSeed(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+#endif // RNG_H
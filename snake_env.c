@@ -0,0 +1,381 @@
+// Reinforcement-learning environment over the game rules, see snake_env.h
+#include "snake_env.h"
+#include "game.h"
+#include "snake_obs.h"
+#include <stdlib.h>
+
+// SNAKE_LAYOUT_CELLS observations show the board's cellMap[] values as is
+_Static_assert(SNAKE_OBS_EMPTY == CELL_EMPTY && SNAKE_OBS_BODY == CELL_BODY &&
+               SNAKE_OBS_FOOD == CELL_FOOD && SNAKE_OBS_TEMP_FOOD == CELL_TEMP_FOOD &&
+               SNAKE_OBS_TEMP_FOOD_DOUBLE == CELL_TEMP_FOOD_DOUBLE &&
+               SNAKE_OBS_TEMP_FOOD_TRIPLE == CELL_TEMP_FOOD_TRIPLE &&
+               SNAKE_OBS_SPECIAL == CELL_SPECIAL && SNAKE_OBS_DEATH == CELL_DEATH,
+               "observation values must match CellType");
+_Static_assert(SNAKE_ACTION_UP == UP && SNAKE_ACTION_DOWN == DOWN &&
+               SNAKE_ACTION_LEFT == LEFT && SNAKE_ACTION_RIGHT == RIGHT,
+               "actions must match Direction");
+
+static const SnakeObsSpec defaultObsSpec = { SNAKE_LAYOUT_CELLS, 0, 0 };
+
+struct SnakeEnv {
+    GameState *gs;
+    ObsEncoder enc;
+    int score;  // Score after the last step, for the reward
+};
+
+SnakeEnvConfig snakeEnvDefaultConfig(void) {
+    GameConfig game = defaultGameConfig();
+    SnakeEnvConfig config = { game.cols, game.rows, game.maxFood, game.maxTempFood, game.maxDeathItems };
+    return config;
+}
+
+SnakeEnv *snakeEnvCreate(const SnakeEnvConfig *config) {
+    GameConfig game = { config->rows, config->cols, config->maxFood, config->maxTempFood,
+                        config->maxDeathItems };
+    if (!validateGameConfig(&game)) return NULL;
+
+    SnakeEnv *env = malloc(sizeof(*env));
+    if (!env) return NULL;
+    env->gs = createGameState(&game, 0);
+    if (!env->gs || !obsEncoderInit(&env->enc, env->gs, &defaultObsSpec)) {
+        destroyGameState(env->gs);
+        free(env);
+        return NULL;
+    }
+    env->score = 0;
+    return env;
+}
+
+void snakeEnvDestroy(SnakeEnv *env) {
+    if (!env) return;
+    obsEncoderFree(&env->enc);
+    destroyGameState(env->gs);
+    free(env);
+}
+
+// Swap in an encoder for spec, or keep the old one if spec is invalid
+static int replaceEncoder(ObsEncoder *enc, const GameState *gs, const SnakeObsSpec *spec) {
+    ObsEncoder next;
+    if (!obsEncoderInit(&next, gs, spec)) return 0;
+    obsEncoderFree(enc);
+    *enc = next;
+    return 1;
+}
+
+int32_t snakeEnvSetObservation(SnakeEnv *env, const SnakeObsSpec *spec) {
+    return replaceEncoder(&env->enc, env->gs, spec);
+}
+
+size_t snakeEnvObservationSize(const SnakeEnv *env) {
+    return env->enc.size;
+}
+
+void snakeEnvObserve(const SnakeEnv *env, uint8_t *obs) {
+    obsEncodeFull(&env->enc, env->gs, obs);
+}
+
+void snakeEnvReset(SnakeEnv *env, uint64_t seed, uint8_t *obs) {
+    seedGameState(env->gs, seed);
+    resetGameState(env->gs);
+    obsEncoderReset(&env->enc, env->gs);
+    env->score = 0;
+    if (obs) obsEncode(&env->enc, env->gs, obs);
+}
+
+SnakeEnvStep snakeEnvStep(SnakeEnv *env, int32_t action, uint8_t *obs) {
+    GameState *gs = env->gs;
+    SnakeEnvStep result = { 0.0f, 1, env->score };
+
+    if (!gs->gameOver) {
+        if (action >= SNAKE_ACTION_UP && action <= SNAKE_ACTION_RIGHT) steerSnake(gs, (Direction)action);
+        advanceToNextMove(gs);
+        obsEncoderTrack(&env->enc, gs);
+
+        int score = gameScore(gs);
+        result.reward = (float)(score - env->score);
+        result.done = gs->gameOver;
+        result.score = score;
+        env->score = score;
+    }
+    if (obs) obsEncode(&env->enc, gs, obs);
+    return result;
+}
+
+/* ------------------ VECTOR ENVIRONMENT ------------------*/
+// Most steps are the same few operations: steer, count down to the move
+// frame, check that no event falls due by then and that the head stays on
+// the board. Those run as one loop over per-lane int32 arrays, which the
+// compiler can vectorise, without touching any GameState. The move itself,
+// and everything else, is done per game: lanes that pass the checks move
+// the head into an empty cell, the rest take the full GameState path and
+// then reload their lane fields from it.
+struct SnakeVecEnv {
+    int count;
+    int cols;
+    int rows;
+    size_t obsSize;
+    uint64_t seed;        // Base seed from the last reset
+    GameState **games;
+    ObsEncoder *encoders;
+    // Lane fields, derived from the GameState ones
+    int32_t *moveIn;      // Frames to the next move, counting the move frame
+    int32_t *interval;    // Frames between moves
+    int32_t *eventIn;     // Frames to the earliest pending event, capped at INT32_MAX
+    int32_t *direction;
+    int32_t *headX;
+    int32_t *headY;
+    int32_t *advance;     // Frames the lane loop advanced this step
+    int32_t *plain;       // Set by the lane loop when the step needs no events
+    int32_t *score;       // Score after the last step
+    uint32_t *episode;    // Games finished in this slot since the reset
+};
+
+// Seed for the given episode of game slot i, independent of other slots.
+// Documented in snake_env.h so a single SnakeEnv can replay a slot.
+static uint64_t vecGameSeed(uint64_t seed, int i, uint32_t episode) {
+    return mixSeed(mixSeed(seed + (uint64_t)i * 0x9E3779B97F4A7C15ull) + episode);
+}
+
+// Set lane i's fields from its GameState, after anything but a plain step
+static void loadLane(SnakeVecEnv *venv, int i) {
+    const GameState *gs = venv->games[i];
+    Point head = snakeSegment(gs, 0);
+    int32_t interval = currentMoveInterval(gs);
+    int32_t idle = interval - gs->movementFrameCounter - 1;
+    uint64_t eventIn = nextEventFrame(gs) - gs->frame;  // Events due by now have run
+    venv->moveIn[i] = (idle > 0 ? idle : 0) + 1;
+    venv->interval[i] = interval;
+    venv->eventIn[i] = eventIn < INT32_MAX ? (int32_t)eventIn : INT32_MAX;
+    venv->direction[i] = gs->snake.direction;
+    venv->headX[i] = head.x;
+    venv->headY[i] = head.y;
+}
+
+static void resetSlot(SnakeVecEnv *venv, int i) {
+    seedGameState(venv->games[i], vecGameSeed(venv->seed, i, venv->episode[i]));
+    resetGameState(venv->games[i]);
+    obsEncoderReset(&venv->encoders[i], venv->games[i]);
+    venv->score[i] = 0;
+    loadLane(venv, i);
+}
+
+SnakeVecEnv *snakeVecEnvCreate(const SnakeEnvConfig *config, int32_t count) {
+    GameConfig game = { config->rows, config->cols, config->maxFood, config->maxTempFood,
+                        config->maxDeathItems };
+    if (count < 1 || !validateGameConfig(&game)) return NULL;
+
+    SnakeVecEnv *venv = calloc(1, sizeof(*venv));
+    if (!venv) return NULL;
+    size_t n = (size_t)count;
+    venv->games = calloc(n, sizeof(GameState *));
+    venv->encoders = calloc(n, sizeof(ObsEncoder));
+    venv->moveIn = calloc(n, sizeof(int32_t));
+    venv->interval = calloc(n, sizeof(int32_t));
+    venv->eventIn = calloc(n, sizeof(int32_t));
+    venv->direction = calloc(n, sizeof(int32_t));
+    venv->headX = calloc(n, sizeof(int32_t));
+    venv->headY = calloc(n, sizeof(int32_t));
+    venv->advance = calloc(n, sizeof(int32_t));
+    venv->plain = calloc(n, sizeof(int32_t));
+    venv->score = calloc(n, sizeof(int32_t));
+    venv->episode = calloc(n, sizeof(uint32_t));
+    if (!venv->games || !venv->encoders || !venv->moveIn || !venv->interval || !venv->eventIn ||
+        !venv->direction || !venv->headX || !venv->headY || !venv->advance || !venv->plain ||
+        !venv->score || !venv->episode) {
+        snakeVecEnvDestroy(venv);
+        return NULL;
+    }
+    venv->count = count;
+    venv->cols = game.cols;
+    venv->rows = game.rows;
+    for (int i = 0; i < count; i++) {
+        venv->games[i] = createGameState(&game, 0);
+        if (!venv->games[i] || !obsEncoderInit(&venv->encoders[i], venv->games[i], &defaultObsSpec)) {
+            snakeVecEnvDestroy(venv);
+            return NULL;
+        }
+        loadLane(venv, i);
+    }
+    venv->obsSize = venv->encoders[0].size;
+    return venv;
+}
+
+void snakeVecEnvDestroy(SnakeVecEnv *venv) {
+    if (!venv) return;
+    for (int i = 0; i < venv->count; i++) {
+        if (venv->encoders) obsEncoderFree(&venv->encoders[i]);
+        if (venv->games) destroyGameState(venv->games[i]);
+    }
+    free(venv->games);
+    free(venv->encoders);
+    free(venv->moveIn);
+    free(venv->interval);
+    free(venv->eventIn);
+    free(venv->direction);
+    free(venv->headX);
+    free(venv->headY);
+    free(venv->advance);
+    free(venv->plain);
+    free(venv->score);
+    free(venv->episode);
+    free(venv);
+}
+
+int32_t snakeVecEnvCount(const SnakeVecEnv *venv) {
+    return venv->count;
+}
+
+int32_t snakeVecEnvSetObservation(SnakeVecEnv *venv, const SnakeObsSpec *spec) {
+    // Build every encoder before swapping any, so a failure changes nothing
+    ObsEncoder *next = calloc((size_t)venv->count, sizeof(ObsEncoder));
+    if (!next) return 0;
+    for (int i = 0; i < venv->count; i++) {
+        if (!obsEncoderInit(&next[i], venv->games[i], spec)) {
+            while (i-- > 0) obsEncoderFree(&next[i]);
+            free(next);
+            return 0;
+        }
+    }
+    for (int i = 0; i < venv->count; i++) obsEncoderFree(&venv->encoders[i]);
+    free(venv->encoders);
+    venv->encoders = next;
+    venv->obsSize = next[0].size;
+    return 1;
+}
+
+size_t snakeVecEnvObservationSize(const SnakeVecEnv *venv) {
+    return venv->obsSize;
+}
+
+void snakeVecEnvReset(SnakeVecEnv *venv, uint64_t seed, uint8_t *obs) {
+    venv->seed = seed;
+    for (int i = 0; i < venv->count; i++) {
+        venv->episode[i] = 0;
+        resetSlot(venv, i);
+        if (obs) obsEncode(&venv->encoders[i], venv->games[i], obs + (size_t)i * venv->obsSize);
+    }
+}
+
+#if defined(__GNUC__) || defined(__clang__)
+    #define PREFETCH(addr) __builtin_prefetch(addr)
+#else
+    #define PREFETCH(addr) ((void)(addr))
+#endif
+#define PREFETCH_STATE_AHEAD 8  // Games ahead to fetch GameState lines for
+#define PREFETCH_BOARD_AHEAD 4  // Games ahead to fetch the head's cell and the body ring for
+
+// Large batches do not fit in cache, so the game loop fetches the next
+// games' lines while it works on the current one. The lane loop already
+// knows where each head goes, but the board arrays are found through the
+// GameState, hence the two stages.
+static inline void prefetchState(const GameState *gs) {
+    PREFETCH(gs);
+    PREFETCH(&gs->dirtyCount);
+    PREFETCH(&gs->food);
+    PREFETCH(&gs->frame);
+    PREFETCH(&gs->events);
+}
+
+static inline void prefetchBoard(const SnakeVecEnv *venv, int i) {
+    if (!venv->plain[i]) return;
+    const GameState *gs = venv->games[i];
+    uint32_t cell = (uint32_t)(venv->headY[i] * venv->cols + venv->headX[i]);
+    int tail = gs->snake.head + gs->snake.segments - 1;
+    if (tail >= gs->boardCells) tail -= gs->boardCells;
+    PREFETCH(gs->snake.body + (gs->snake.head == 0 ? gs->boardCells - 1 : gs->snake.head - 1));
+    PREFETCH(gs->snake.body + tail);
+    PREFETCH(gs->cellMap + cell);
+    PREFETCH(gs->freeSlot + cell);
+    PREFETCH(gs->occupancy + (uint32_t)venv->headY[i] * (uint32_t)gs->occWords);
+}
+
+#define LANE_BLOCK 8  // Lanes per block of the lane loop, a whole number of vectors
+
+// The plain step for lanes [begin, begin + n): steer, count down to the move
+// frame and move the head one cell. Marks the lanes where that is not the
+// whole step, because an event falls due by the move frame or the head
+// leaves the board. Only int32 lanes, no branches and restrict parameters,
+// so it vectorises.
+static inline void stepLaneRange(int begin, int n, uint32_t cols, uint32_t rows,
+                                 const int32_t *restrict actions, int32_t *restrict moveIn,
+                                 const int32_t *restrict interval, int32_t *restrict eventIn,
+                                 int32_t *restrict direction, int32_t *restrict headX,
+                                 int32_t *restrict headY, int32_t *restrict advance,
+                                 int32_t *restrict plain) {
+    for (int k = 0; k < n; k++) {
+        int i = begin + k;
+        // Opposite directions pair up as 0/1 and 2/3, see steerSnake()
+        uint32_t action = (uint32_t)actions[i];
+        int32_t dir = direction[i];
+        dir = action <= SNAKE_ACTION_RIGHT && action != ((uint32_t)dir ^ 1) ? (int32_t)action : dir;
+        int32_t x = headX[i] + (dir == RIGHT) - (dir == LEFT);
+        int32_t y = headY[i] + (dir == DOWN) - (dir == UP);
+        int32_t frames = moveIn[i];
+        plain[i] = (eventIn[i] > frames) & ((uint32_t)x < cols) & ((uint32_t)y < rows);
+
+        advance[i] = frames;
+        eventIn[i] -= frames;
+        moveIn[i] = interval[i];
+        direction[i] = dir;
+        headX[i] = x;
+        headY[i] = y;
+    }
+}
+
+// Whole blocks first: with a constant trip count compilers vectorise the
+// loop even at -O2, where they will not add a scalar epilogue
+static void stepLanes(SnakeVecEnv *venv, const int32_t *actions) {
+    uint32_t cols = (uint32_t)venv->cols;
+    uint32_t rows = (uint32_t)venv->rows;
+    int i = 0;
+    for (; i + LANE_BLOCK <= venv->count; i += LANE_BLOCK) {
+        stepLaneRange(i, LANE_BLOCK, cols, rows, actions, venv->moveIn, venv->interval, venv->eventIn,
+                      venv->direction, venv->headX, venv->headY, venv->advance, venv->plain);
+    }
+    stepLaneRange(i, venv->count - i, cols, rows, actions, venv->moveIn, venv->interval, venv->eventIn,
+                  venv->direction, venv->headX, venv->headY, venv->advance, venv->plain);
+}
+
+// The whole step on the GameState, for lanes the plain step does not cover
+static void fullStep(SnakeVecEnv *venv, int i, float *reward, int32_t *done, int32_t *score) {
+    GameState *gs = venv->games[i];
+    gs->nextDirection = venv->direction[i];  // Steered by the lane loop
+    advanceToNextMove(gs);
+    obsEncoderTrack(&venv->encoders[i], gs);
+
+    *score = gameScore(gs);
+    *reward = (float)(*score - venv->score[i]);
+    *done = gs->gameOver;
+    venv->score[i] = *score;
+
+    // Start the slot's next game right away; obs shows its first frame
+    if (gs->gameOver) {
+        venv->episode[i]++;
+        resetSlot(venv, i);
+    } else {
+        loadLane(venv, i);
+    }
+}
+
+void snakeVecEnvStep(SnakeVecEnv *venv, const int32_t *actions, uint8_t *obs, float *rewards,
+                     int32_t *dones, int32_t *scores) {
+    stepLanes(venv, actions);
+    for (int i = 0; i < venv->count; i++) {
+        if (i + PREFETCH_STATE_AHEAD < venv->count) prefetchState(venv->games[i + PREFETCH_STATE_AHEAD]);
+        if (i + PREFETCH_BOARD_AHEAD < venv->count) prefetchBoard(venv, i + PREFETCH_BOARD_AHEAD);
+        GameState *gs = venv->games[i];
+        Point next = { venv->headX[i], venv->headY[i] };
+        int32_t score;
+        uint64_t moveFrame = gs->frame + (uint64_t)venv->advance[i];
+        if (venv->plain[i] && advanceOntoEmptyCell(gs, venv->direction[i], next, moveFrame)) {
+            obsEncoderTrack(&venv->encoders[i], gs);
+            score = venv->score[i];
+            rewards[i] = 0.0f;
+            dones[i] = 0;
+        } else {
+            fullStep(venv, i, &rewards[i], &dones[i], &score);
+        }
+        if (scores) scores[i] = score;
+        if (obs) obsEncode(&venv->encoders[i], gs, obs + (size_t)i * venv->obsSize);
+    }
+}
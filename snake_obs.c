@@ -0,0 +1,267 @@
+// Observation encoders, see snake_obs.h and the layouts in snake_env.h
+#include "snake_obs.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Plane of each CellType, -1 for none. Temp food types are consecutive in
+// both enums.
+static const signed char cellPlane[] = {
+    [CELL_EMPTY] = -1,
+    [CELL_BODY] = SNAKE_PLANE_BODY,
+    [CELL_FOOD] = SNAKE_PLANE_FOOD,
+    [CELL_TEMP_FOOD] = SNAKE_PLANE_TEMP_FOOD,
+    [CELL_TEMP_FOOD_DOUBLE] = SNAKE_PLANE_TEMP_FOOD_DOUBLE,
+    [CELL_TEMP_FOOD_TRIPLE] = SNAKE_PLANE_TEMP_FOOD_TRIPLE,
+    [CELL_SPECIAL] = SNAKE_PLANE_SPECIAL,
+    [CELL_DEATH] = SNAKE_PLANE_DEATH,
+};
+
+// What one observation cell shows
+typedef struct {
+    int code;      // SNAKE_OBS_* value
+    float timeLeft; // Temp food time left as a fraction, 1 for anything else
+    float age;      // Body age plane value, 0 off the body
+} CellView;
+
+static size_t planeCells(const ObsEncoder *enc) {
+    return (size_t)enc->width * (size_t)enc->height;
+}
+
+int obsEncoderInit(ObsEncoder *enc, const GameState *gs, const SnakeObsSpec *spec) {
+    if (spec->layout < SNAKE_LAYOUT_CELLS || spec->layout > SNAKE_LAYOUT_FLOAT) return 0;
+    if (spec->crop < 0 || (spec->crop > 0 && (spec->crop % 2 == 0 || spec->crop > MAX_BOARD_DIM))) return 0;
+    if (spec->inPlace != 0 && spec->inPlace != 1) return 0;
+
+    memset(enc, 0, sizeof(*enc));
+    enc->spec = *spec;
+    enc->width = spec->crop ? spec->crop : gs->config.cols;
+    enc->height = spec->crop ? spec->crop : gs->config.rows;
+    enc->planeBytes = (planeCells(enc) + 7) / 8;
+    enc->scalars = (size_t)SNAKE_SCALAR_TEMP_FOOD + (size_t)gs->config.maxTempFood;
+    switch (spec->layout) {
+        case SNAKE_LAYOUT_CELLS:
+            enc->size = planeCells(enc);
+            break;
+        case SNAKE_LAYOUT_BITS:
+            enc->size = SNAKE_PLANE_BITS * enc->planeBytes + enc->scalars;
+            break;
+        default:
+            enc->size = (SNAKE_PLANE_COUNT * planeCells(enc) + enc->scalars) * sizeof(float);
+            break;
+    }
+    enc->laidAt = calloc((size_t)gs->boardCells, sizeof(uint32_t));
+    if (!enc->laidAt) return 0;
+    obsEncoderReset(enc, gs);
+    return 1;
+}
+
+void obsEncoderFree(ObsEncoder *enc) {
+    free(enc->laidAt);
+    enc->laidAt = NULL;
+}
+
+void obsEncoderReset(ObsEncoder *enc, const GameState *gs) {
+    // Number the starting segments as if laid one move apart
+    int segments = gs->snake.segments;
+    enc->moves = (uint32_t)segments;
+    for (int i = 0; i < segments; i++) {
+        int idx = gs->snake.head + i;
+        if (idx >= gs->boardCells) idx -= gs->boardCells;
+        enc->laidAt[gs->snake.body[idx]] = (uint32_t)(segments - i);
+    }
+    enc->trackedHead = snakeHeadCell(gs);
+    enc->written = 0;
+}
+
+void obsEncoderTrack(ObsEncoder *enc, const GameState *gs) {
+    uint32_t head = snakeHeadCell(gs);
+    if (head == enc->trackedHead) return;  // The move that ended the game did not happen
+    enc->laidAt[head] = ++enc->moves;
+    enc->trackedHead = head;
+}
+
+/* ------------------ CELLS ------------------*/
+// Body age plane value of the segment the head left age moves ago: 1 on the
+// head, 1 / segments on the tail
+static float bodyAgeValue(int age, int segments) {
+    return (float)(segments - age) / (float)segments;
+}
+
+static float bodyAge(const ObsEncoder *enc, const GameState *gs, uint32_t cell) {
+    return bodyAgeValue((int)(enc->moves - enc->laidAt[cell]), gs->snake.segments);
+}
+
+static float tempFoodFraction(const GameState *gs, const TempFood *tf) {
+    return (float)tempFoodTimeLeft(gs, tf) / (float)tempFoodLifetime(tf->foodType);
+}
+
+static CellView viewCell(const ObsEncoder *enc, const GameState *gs, uint32_t cell) {
+    CellView v = { gs->cellMap[cell], 1.0f, 0.0f };
+    if (v.code == CELL_BODY) {
+        if (cell == snakeHeadCell(gs)) v.code = SNAKE_OBS_HEAD;
+        v.age = bodyAge(enc, gs, cell);
+    } else if (v.code >= CELL_TEMP_FOOD && v.code <= CELL_TEMP_FOOD_TRIPLE) {
+        v.timeLeft = tempFoodFraction(gs, &gs->tempFood[gs->cellItem[cell]]);
+    }
+    return v;
+}
+
+static const CellView wallView = { SNAKE_OBS_WALL, 1.0f, 0.0f };
+
+// Set the planes of one cell at position i, which must be clear
+static void setCell(const ObsEncoder *enc, uint8_t *obs, size_t i, CellView v) {
+    int plane = v.code == SNAKE_OBS_HEAD ? SNAKE_PLANE_BODY
+              : v.code == SNAKE_OBS_WALL ? SNAKE_PLANE_WALL
+              : cellPlane[v.code];
+
+    if (enc->spec.layout == SNAKE_LAYOUT_CELLS) {
+        obs[i] = (uint8_t)v.code;
+    } else if (enc->spec.layout == SNAKE_LAYOUT_BITS) {
+        uint8_t bit = (uint8_t)(1u << (i % 8));
+        uint8_t *byte = obs + i / 8;
+        if (plane >= 0) byte[plane * enc->planeBytes] |= bit;
+        if (v.code == SNAKE_OBS_HEAD) byte[SNAKE_PLANE_HEAD * enc->planeBytes] |= bit;
+    } else {
+        float *planes = (float *)obs;
+        size_t stride = planeCells(enc);
+        if (plane >= 0) planes[plane * stride + i] = v.timeLeft;
+        if (v.code == SNAKE_OBS_HEAD) planes[SNAKE_PLANE_HEAD * stride + i] = 1.0f;
+        planes[SNAKE_PLANE_BODY_AGE * stride + i] = v.age;
+    }
+}
+
+// Overwrite one cell at position i, clearing whatever was there
+static void writeCell(const ObsEncoder *enc, uint8_t *obs, size_t i, CellView v) {
+    if (enc->spec.layout == SNAKE_LAYOUT_BITS) {
+        uint8_t bit = (uint8_t)(1u << (i % 8));
+        uint8_t *byte = obs + i / 8;
+        for (int p = 0; p < SNAKE_PLANE_BITS; p++) byte[p * enc->planeBytes] &= (uint8_t)~bit;
+    } else if (enc->spec.layout == SNAKE_LAYOUT_FLOAT) {
+        float *planes = (float *)obs;
+        size_t stride = planeCells(enc);
+        for (int p = 0; p < SNAKE_PLANE_COUNT; p++) planes[p * stride + i] = 0.0f;
+    }
+    setCell(enc, obs, i, v);
+}
+
+static void setScalar(const ObsEncoder *enc, uint8_t *obs, int s, float value) {
+    if (enc->spec.layout == SNAKE_LAYOUT_BITS)
+        obs[SNAKE_PLANE_BITS * enc->planeBytes + (size_t)s] = (uint8_t)(value * 255.0f + 0.5f);
+    else
+        ((float *)obs)[SNAKE_PLANE_COUNT * planeCells(enc) + (size_t)s] = value;
+}
+
+static void writeScalars(const ObsEncoder *enc, const GameState *gs, uint8_t *obs) {
+    if (enc->spec.layout == SNAKE_LAYOUT_CELLS) return;
+    setScalar(enc, obs, SNAKE_SCALAR_BOOST, (float)speedBoostFramesLeft(gs) / (float)SPEED_BOOST_DURATION);
+    for (int d = UP; d <= RIGHT; d++)
+        setScalar(enc, obs, SNAKE_SCALAR_DIRECTION + d, d == gs->snake.direction ? 1.0f : 0.0f);
+    setScalar(enc, obs, SNAKE_SCALAR_LENGTH, gs->snake.length >= gs->boardCells
+                                             ? 1.0f : (float)gs->snake.length / (float)gs->boardCells);
+    for (int t = 0; t < gs->config.maxTempFood; t++) {
+        float left = t < gs->tempFoodCount ? tempFoodFraction(gs, &gs->tempFood[t]) : 0.0f;
+        setScalar(enc, obs, SNAKE_SCALAR_TEMP_FOOD + t, left);
+    }
+}
+
+/* ------------------ WHOLE BOARD ------------------*/
+// Temp food time left changes on every step without a cell change. Only
+// the float layout shows it on the board.
+static void refreshTempFood(const ObsEncoder *enc, const GameState *gs, uint8_t *obs) {
+    if (enc->spec.layout != SNAKE_LAYOUT_FLOAT) return;
+    float *planes = (float *)obs;
+    size_t stride = planeCells(enc);
+    for (int t = 0; t < gs->tempFoodCount; t++) {
+        const TempFood *tf = &gs->tempFood[t];
+        int plane = SNAKE_PLANE_TEMP_FOOD + tf->foodType;
+        size_t cell = (size_t)tf->pos.y * (size_t)gs->config.cols + (size_t)tf->pos.x;
+        planes[plane * stride + cell] = tempFoodFraction(gs, tf);
+    }
+}
+
+// Every move ages the whole body, so the float layout rewrites the age of
+// every segment on every step, O(length). Segments follow the head in the
+// body ring, one move older each.
+static void refreshBodyAge(const ObsEncoder *enc, const GameState *gs, uint8_t *obs) {
+    if (enc->spec.layout != SNAKE_LAYOUT_FLOAT) return;
+    float *age = (float *)obs + SNAKE_PLANE_BODY_AGE * planeCells(enc);
+    int segments = gs->snake.segments;
+    int idx = gs->snake.head;
+    for (int i = 0; i < segments; i++) {
+        age[gs->snake.body[idx]] = bodyAgeValue(i, segments);
+        if (++idx == gs->boardCells) idx = 0;
+    }
+}
+
+static void writeBoard(const ObsEncoder *enc, const GameState *gs, uint8_t *obs) {
+    memset(obs, 0, enc->size);
+    for (int cell = 0; cell < gs->boardCells; cell++) {
+        if (gs->cellMap[cell] != CELL_EMPTY) setCell(enc, obs, (size_t)cell, viewCell(enc, gs, (uint32_t)cell));
+    }
+    writeScalars(enc, gs, obs);
+}
+
+/* ------------------ CROP ------------------*/
+static void writeCrop(const ObsEncoder *enc, const GameState *gs, uint8_t *obs) {
+    Point head = snakeSegment(gs, 0);
+    int half = enc->spec.crop / 2;
+    int left = head.x - half;
+    // Window columns that fall on the board, the same for every row
+    int from = left < 0 ? -left : 0;
+    int to = left + enc->width > gs->config.cols ? gs->config.cols - left : enc->width;
+
+    memset(obs, 0, enc->size);
+    for (int wy = 0; wy < enc->height; wy++) {
+        int y = head.y - half + wy;
+        size_t row = (size_t)wy * (size_t)enc->width;
+        if (y < 0 || y >= gs->config.rows) {
+            for (int wx = 0; wx < enc->width; wx++) setCell(enc, obs, row + (size_t)wx, wallView);
+            continue;
+        }
+        for (int wx = 0; wx < from; wx++) setCell(enc, obs, row + (size_t)wx, wallView);
+        for (int wx = to; wx < enc->width; wx++) setCell(enc, obs, row + (size_t)wx, wallView);
+
+        int base = y * gs->config.cols + left;  // Board cell of window column 0
+        if (enc->spec.layout == SNAKE_LAYOUT_CELLS) {
+            memcpy(obs + row + from, gs->cellMap + base + from, (size_t)(to - from));
+            continue;
+        }
+        for (int wx = from; wx < to; wx++) {
+            uint32_t cell = (uint32_t)(base + wx);
+            if (gs->cellMap[cell] != CELL_EMPTY) setCell(enc, obs, row + (size_t)wx, viewCell(enc, gs, cell));
+        }
+    }
+    // The copied rows show the head as body
+    if (enc->spec.layout == SNAKE_LAYOUT_CELLS) obs[(size_t)half * (size_t)enc->width + (size_t)half] = SNAKE_OBS_HEAD;
+    writeScalars(enc, gs, obs);
+}
+
+/* ------------------ ENCODING ------------------*/
+void obsEncodeFull(const ObsEncoder *enc, const GameState *gs, uint8_t *obs) {
+    if (enc->spec.crop)
+        writeCrop(enc, gs, obs);
+    else
+        writeBoard(enc, gs, obs);
+}
+
+void obsEncode(ObsEncoder *enc, GameState *gs, uint8_t *obs) {
+    // The crop window moves with the head, so every cell in it can change
+    if (!enc->spec.inPlace || !enc->written || enc->spec.crop || gs->dirtyOverflow) {
+        obsEncodeFull(enc, gs, obs);
+    } else {
+        for (int d = 0; d < gs->dirtyCount; d++) {
+            uint32_t cell = gs->dirtyCells[d];
+            writeCell(enc, obs, cell, viewCell(enc, gs, cell));
+        }
+        // The old head is a body cell now, and the new one may not be dirty
+        writeCell(enc, obs, enc->lastHead, viewCell(enc, gs, enc->lastHead));
+        uint32_t head = snakeHeadCell(gs);
+        writeCell(enc, obs, head, viewCell(enc, gs, head));
+        refreshTempFood(enc, gs, obs);
+        refreshBodyAge(enc, gs, obs);
+        writeScalars(enc, gs, obs);
+    }
+    enc->written = 1;
+    enc->lastHead = snakeHeadCell(gs);
+    clearDirtyCells(gs);
+}
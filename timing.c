@@ -0,0 +1,45 @@
+// Monotonic clock and input waits shared by the game loop, headless runs
+// and profiling
+#ifndef _WIN32
+    #define _POSIX_C_SOURCE 200809L  // clock_gettime and poll under strict -std=c11
+#endif
+#include "timing.h"
+#ifdef _WIN32
+    #define NOMINMAX
+    #include <windows.h>
+#else
+    #include <poll.h>
+    #include <time.h>
+    #include <unistd.h>
+#endif
+
+uint64_t monotonicNs(void) {
+#ifdef _WIN32
+    static LARGE_INTEGER frequency;
+    LARGE_INTEGER now;
+    if (frequency.QuadPart == 0)
+        QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&now);
+    // Split the conversion so the multiply cannot overflow on long uptimes
+    uint64_t seconds = (uint64_t)now.QuadPart / (uint64_t)frequency.QuadPart;
+    uint64_t rest = (uint64_t)now.QuadPart % (uint64_t)frequency.QuadPart;
+    return seconds * 1000000000ull + rest * 1000000000ull / (uint64_t)frequency.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+int waitForInput(int64_t timeoutNs) {
+    // Round up, so a wait never ends just before its deadline
+    int64_t ms = timeoutNs < 0 ? -1 : (timeoutNs + 999999) / 1000000;
+    if (ms > 0x7FFFFFFF) ms = 0x7FFFFFFF;
+#ifdef _WIN32
+    HANDLE in = GetStdHandle(STD_INPUT_HANDLE);
+    return WaitForSingleObject(in, ms < 0 ? INFINITE : (DWORD)ms) == WAIT_OBJECT_0;
+#else
+    struct pollfd pfd = { STDIN_FILENO, POLLIN, 0 };
+    return poll(&pfd, 1, (int)ms) > 0;
+#endif
+}